@@ -33,6 +33,9 @@ namespace env::opt
 	view get(pair);
 	bool put(pair, view);
 
+	bool got(atoms);
+	view get(atoms);
+
 	inline auto arg(size_t argn = 0)
 	{
 		const auto argv = arguments();
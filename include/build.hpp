@@ -0,0 +1,185 @@
+#ifndef build_hpp
+#define build_hpp "String Builder"
+
+#include <string_view>
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include <charconv>
+#include <type_traits>
+#include <limits>
+#include <algorithm>
+
+namespace fmt
+{
+	class builder
+	// Appends into an inline buffer that moves to the heap when it fills
+	{
+		static constexpr std::size_t local_size = 256;
+
+		char local[local_size];
+		std::unique_ptr<char[]> heap;
+		char* begin = local;
+		std::size_t used = 0;
+		std::size_t capacity = local_size;
+
+		char* reserve(std::size_t more)
+		// Room for $more characters at the end
+		{
+			if (capacity - used < more)
+			{
+				capacity = std::max(2 * capacity, used + more);
+				std::unique_ptr<char[]> next(new char[capacity]);
+				std::memcpy(next.get(), begin, used);
+				heap = std::move(next);
+				begin = heap.get();
+			}
+			return begin + used;
+		}
+
+	public:
+
+		template <class N> static constexpr bool number = std::is_integral<N>::value
+			// Characters and truth values are not written as numbers
+			and not std::is_same<N, bool>::value
+			and not std::is_same<N, char>::value
+			and not std::is_same<N, signed char>::value
+			and not std::is_same<N, unsigned char>::value
+			and not std::is_same<N, wchar_t>::value
+			and not std::is_same<N, char8_t>::value
+			and not std::is_same<N, char16_t>::value
+			and not std::is_same<N, char32_t>::value;
+
+		builder() = default;
+		builder(const builder&) = delete;
+		builder& operator=(const builder&) = delete;
+
+		builder& append(std::string_view u)
+		{
+			std::memcpy(reserve(u.size()), u.data(), u.size());
+			used += u.size();
+			return *this;
+		}
+
+		builder& append(const char* s)
+		{
+			return append(std::string_view(s));
+		}
+
+		template <class C> requires std::is_same<C, char>::value
+			or std::is_same<C, signed char>::value
+			or std::is_same<C, unsigned char>::value
+		builder& append(C c)
+		// Only these exact types, so an enum is not taken for a character
+		{
+			*reserve(1) = static_cast<char>(c);
+			++ used;
+			return *this;
+		}
+
+		template <class B> requires std::is_same<B, bool>::value
+		builder& append(B b)
+		// As a stream without boolalpha
+		{
+			return append(b ? '1' : '0');
+		}
+
+		template <class N> requires number<N>
+		builder& append(N n, int base = 10)
+		{
+			// Sign and every binary digit at worst
+			constexpr auto size = std::numeric_limits<N>::digits + 2;
+			const auto it = reserve(size);
+			const auto code = std::to_chars(it, it + size, n, base);
+			used = code.ptr - begin;
+			return *this;
+		}
+
+		template <class F> requires std::is_floating_point<F>::value
+		builder& append(F value)
+		// General form with six digits as a stream writes by default
+		{
+			for (std::size_t size = 32; ; size *= 2)
+			{
+				const auto it = reserve(size);
+				#ifdef __cpp_lib_to_chars
+				constexpr auto general = std::chars_format::general;
+				const auto code = std::to_chars(it, it + size, value, general, 6);
+				if (std::errc() == code.ec)
+				{
+					used = code.ptr - begin;
+					return *this;
+				}
+				#else
+				const auto n = std::snprintf(it, size, "%Lg", static_cast<long double>(value));
+				if (n < 0 or static_cast<std::size_t>(n) < size)
+				{
+					used += std::max(n, 0);
+					return *this;
+				}
+				#endif
+			}
+		}
+
+		template <class F> requires std::is_floating_point<F>::value
+		builder& append(F value, int precision)
+		{
+			// Fixed notation of a large value is long, so retry bigger
+			for (std::size_t size = 32 + precision; ; size *= 2)
+			{
+				const auto it = reserve(size);
+				#ifdef __cpp_lib_to_chars
+				constexpr auto fixed = std::chars_format::fixed;
+				const auto code = std::to_chars(it, it + size, value, fixed, precision);
+				if (std::errc() == code.ec)
+				{
+					used = code.ptr - begin;
+					return *this;
+				}
+				#else
+				const auto n = std::snprintf(it, size, "%.*Lf", precision, static_cast<long double>(value));
+				if (n < 0 or static_cast<std::size_t>(n) < size)
+				{
+					used += std::max(n, 0);
+					return *this;
+				}
+				#endif
+			}
+		}
+
+		template <class T> builder& operator<<(const T& x)
+		requires requires (builder& b) { b.append(x); }
+		{
+			return append(x);
+		}
+
+		void clear()
+		{
+			used = 0;
+		}
+
+		std::size_t size() const
+		{
+			return used;
+		}
+
+		const char* data() const
+		{
+			return begin;
+		}
+
+		std::string_view get() const
+		// View that is valid until the next change
+		{
+			return { begin, used };
+		}
+
+		std::string str() const
+		{
+			return { begin, used };
+		}
+	};
+}
+
+#endif // file
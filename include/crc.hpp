@@ -0,0 +1,73 @@
+#ifndef crc_hpp
+#define crc_hpp "Checksum Streams"
+
+#include "fwd.hpp"
+#include "ptr.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace fmt
+{
+	class crcbuf : public fwd::basic_buf<char>
+	// Pass data to or from the $next buffer keeping a CRC32C of all of it
+	{
+	public:
+
+		using base = fwd::basic_buf<char>;
+
+		explicit crcbuf(base* next, std::size_t size = 1 << 16);
+		// Layer on $next buffering $size bytes at a time
+
+		crcbuf(const crcbuf&) = delete;
+		crcbuf& operator=(const crcbuf&) = delete;
+		~crcbuf();
+
+		std::uint32_t digest();
+		// Checksum of all that was written, flushing first, or of all that
+		// the reader has taken from the stream, not what is buffered ahead
+
+		bool verify(std::uint32_t expected)
+		{
+			return digest() == expected;
+		}
+
+	protected:
+
+		int_type overflow(int_type c) override;
+		int_type underflow() override;
+		int sync() override;
+		std::streamsize xsputn(const char_type* s, std::streamsize n) override;
+		std::streamsize xsgetn(char_type* s, std::streamsize n) override;
+
+	private:
+
+		base* next;
+		std::size_t size;
+		std::vector<char> buf;
+		std::uint32_t crc = 0;
+		char* summed = nullptr; // get area is in crc below this
+
+		bool flush();
+		void consume();
+		std::streamsize pass(const char* s, std::streamsize n);
+		std::streamsize take(char* s, std::streamsize n);
+	};
+
+	template
+	<
+		template <class, template <class> class> class Stream
+	>
+	struct basic_crc_stream : fwd::no_copy, Stream<char, std::char_traits>, crcbuf
+	{
+		using stream = Stream<char, std::char_traits>;
+
+		basic_crc_stream(fwd::basic_buf<char>* next)
+		: stream(this), crcbuf(next)
+		{ }
+	};
+
+	using crc_istream = basic_crc_stream<fwd::basic_istream>;
+	using crc_ostream = basic_crc_stream<fwd::basic_ostream>;
+}
+
+#endif // file
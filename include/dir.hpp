@@ -2,35 +2,45 @@
 #define dir_hpp "File Directory"
 
 #include "fmt.hpp"
+#include "type.hpp"
 #include "tmp.hpp"
 #include "mode.hpp"
 
 namespace fmt::path
 {
 	vector split(view);
-	string join(span);
+	tokens tokenize(view);
+	string join(const_span);
 	string join(init);
+	string& join_to(string&, const_span);
+	string& join_to(string&, init);
 }
 
 namespace fmt::dir
 {
 	vector split(view);
-	string join(span);
+	tokens tokenize(view);
+	string join(const_span);
 	string join(init);
+	string& join_to(string&, const_span);
+	string& join_to(string&, init);
 }
 
 namespace fmt::file
 {
 	vector split(view);
-	string join(span);
+	tokens tokenize(view);
+	string join(const_span);
 	string join(init);
+	string& join_to(string&, const_span);
+	string& join_to(string&, init);
 }
 
 namespace env::file
 {
 	using string = fmt::string;
 	using view = fmt::view;
-	using span = fmt::span;
+	using span = fmt::const_span;
 	using order = fwd::pair<view, span>;
 	using entry = fwd::predicate<view>;
 	using notify = fwd::relation<view, mode>;
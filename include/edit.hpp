@@ -0,0 +1,133 @@
+#ifndef edit_hpp
+#define edit_hpp "Text Editing"
+
+#include "fmt.hpp"
+#include "it.hpp"
+
+namespace fmt
+{
+	template <class Char> struct basic_piece_table
+	{
+		using string = basic_string<Char>;
+		using view = typename string::view;
+		using output = typename view::output;
+
+		basic_piece_table(view u = { });
+		// Edit the text in $u which must outlive the table
+
+		size_type size() const;
+		// Number of code units in the edited text
+
+		bool empty() const
+		{
+			return 0 == size();
+		}
+
+		void insert(size_type pos, view w);
+		// Insert $w before position $pos
+
+		void erase(size_type pos, size_type n = npos);
+		// Erase up to $n code units from position $pos
+
+		void replace(size_type pos, size_type n, view w);
+		// Replace up to $n code units from position $pos with $w
+
+		string str() const;
+		// Flatten all the pieces into one string
+
+		friend output operator<<(output out, const basic_piece_table& p)
+		{
+			for (const auto u : p) out << u;
+			return out;
+		}
+
+	private:
+
+		struct node
+		{
+			size_type pos, size, total;
+			bool added;
+			unsigned rank;
+			int left, right;
+		};
+
+		view base;
+		string added;
+		fwd::vector<node> nodes;
+		fwd::vector<int> free;
+		unsigned seed = 2463534242u;
+		int root = -1;
+
+		view piece(int n) const;
+		size_type total(int n) const;
+		void update(int n);
+		int make(bool add, size_type pos, size_type size, unsigned rank);
+		void split(int t, size_type k, int& l, int& r);
+		int merge(int l, int r);
+		void drop(int t);
+
+	public:
+
+		struct cursor
+		// In order walk of the pieces as views
+		{
+			const basic_piece_table* that;
+			fwd::vector<int> stack;
+
+			cursor(const basic_piece_table* that, int n)
+			: that(that)
+			{
+				descend(n);
+			}
+
+			bool operator!=(const cursor& it) const
+			{
+				return it.top() != top();
+			}
+
+			view value() const
+			{
+				return that->piece(stack.back());
+			}
+
+			void next()
+			{
+				const auto n = stack.back();
+				stack.pop_back();
+				descend(that->nodes[n].right);
+			}
+
+		private:
+
+			int top() const
+			{
+				return stack.empty() ? -1 : stack.back();
+			}
+
+			void descend(int n)
+			{
+				for (; 0 <= n; n = that->nodes[n].left)
+				{
+					stack.push_back(n);
+				}
+			}
+		};
+
+		using iterator = fwd::iterate<cursor>;
+
+		iterator begin() const
+		{
+			return iterator(this, root);
+		}
+
+		iterator end() const
+		{
+			return iterator(this, -1);
+		}
+	};
+
+	using piece_table = basic_piece_table<char>;
+	using wpiece_table = basic_piece_table<wchar_t>;
+}
+
+#endif // file
@@ -2,6 +2,7 @@
 #define env_hpp "Environment Variables"
 
 #include "fmt.hpp"
+#include "lines.hpp"
 
 namespace env
 {
@@ -12,8 +13,8 @@ namespace env
 	bool put(fmt::view);
 	bool put(fmt::view, fmt::view);
 	// common
-	fmt::span vars();
-	fmt::span path();
+	const fmt::lines& vars();
+	const fmt::lines& path();
 	fmt::view temp();
 	fmt::view pwd();
 	fmt::view base();
@@ -12,6 +12,8 @@
 #	undef assert
 #endif
 
+#include "format.hpp"
+
 namespace fmt
 {
 	struct where
@@ -22,13 +24,31 @@ namespace fmt
 		const char * code;
 	};
 
-	std::ostream& out(); std::ostream& put(std::ostream&);
+	std::ostream& out(); std::ostream& results(); std::ostream& put(std::ostream&);
+	// Failures, results such as timings, and failures flushed to a stream
 
 	template <class... Type> auto& printer(std::ostream& out, const where& at, const Type&... args)
 	{
-		out << at.file << "(" << at.line << ")" << at.func << ":" << at.code << ";";
-		if constexpr (0 < sizeof...(Type)) ((out << ' ' << args), ...);
-		return out;
+		builder buf;
+		format_to<"{}({}){}:{};">(buf, at.file, at.line, at.func, at.code);
+		if constexpr (0 < sizeof...(Type))
+		{
+			// Types the builder lacks are streamed in their place
+			auto put = [&](const auto& arg)
+			{
+				if constexpr (requires { buf << arg; })
+				{
+					buf << ' ' << arg;
+				}
+				else
+				{
+					out << buf.get() << ' ' << arg;
+					buf.clear();
+				}
+			};
+			(put(args), ...);
+		}
+		return out << buf.get();
 	}
 
 	extern bool debug;
@@ -59,10 +79,16 @@ namespace fmt
 #include "sym.hpp" // dynamic
 
 #define TEST(name) dynamic void name##_UNIT_TEST_SUFFIX ()
+#define BENCH(name) dynamic void name##_UNIT_BENCH_SUFFIX ()
 
 namespace env::test
 {
 	constexpr auto suffix = "_UNIT_TEST_SUFFIX";
 };
 
+namespace env::bench
+{
+	constexpr auto suffix = "_UNIT_BENCH_SUFFIX";
+};
+
 #endif // file
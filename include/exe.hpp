@@ -2,72 +2,71 @@
 #define exe_hpp "Execute Command Line"
 
 #include "fmt.hpp"
+#include "lines.hpp"
 
 namespace env::exe
 {
-	void clear(); // empty the string cache
+	fmt::lines get(fmt::input in, char end = '\n', int count = -1);
+	// Read an amount of delimited input lines
 
-	fmt::vector get(fmt::input in, char end = '\n', int count = -1);
-	// Cache an amount of delimited input lines
-
-	fmt::vector get(fmt::span args);
+	fmt::lines get(fmt::span args);
 	// Run using vector view
 
-	fmt::vector get(fmt::init args);
+	fmt::lines get(fmt::init args);
 	// Run using initializers
 
-	fmt::vector echo(fmt::view line);
+	fmt::lines echo(fmt::view line);
 	// Expand macros in line
 
-	fmt::vector list(fmt::view directory = ".");
+	fmt::lines list(fmt::view directory = ".");
 	// List files in a directory
 
-	fmt::vector copy(fmt::view path);
+	fmt::lines copy(fmt::view path);
 	// Lines in file given by path
 
-	fmt::vector find(fmt::view pattern, fmt::view directory = ".");
+	fmt::lines find(fmt::view pattern, fmt::view directory = ".");
 	// Paths to matching files in directory
 
-	fmt::vector which(fmt::view name);
+	fmt::lines which(fmt::view name);
 	// Paths to executables with program name
 
-	fmt::vector start(fmt::view path);
+	fmt::lines start(fmt::view path);
 	// Preferred application for file type at path
 
-	fmt::vector imports(fmt::view path);
+	fmt::lines imports(fmt::view path);
 	// Dump imports in binary at path
 
-	fmt::vector exports(fmt::view path);
+	fmt::lines exports(fmt::view path);
 	// Dump exports in binary at path
 
 	bool desktop(fmt::view name);
 	// Whether name matches current session
 
-	fmt::vector dialog(fmt::param);
+	fmt::lines dialog(fmt::param);
 	// Open dialog with command
 
-	fmt::vector notify(fmt::view text, fmt::view icon = "info");
+	fmt::lines notify(fmt::view text, fmt::view icon = "info");
 	// Show the user a desktop notification
 
-	fmt::vector calendar(fmt::view text = "", fmt::view format = "", int day = 0, int month = 0, int year = 0);
+	fmt::lines calendar(fmt::view text = "", fmt::view format = "", int day = 0, int month = 0, int year = 0);
 	// User selects a calendar data
 
-	fmt::vector color(fmt::view start = "", bool palette = true);
+	fmt::lines color(fmt::view start = "", bool palette = true);
 	// User selects a color value
 
-	fmt::vector enter(fmt::view start, fmt::view label = "", bool hide = false);
+	fmt::lines enter(fmt::view start, fmt::view label = "", bool hide = false);
 	// User enters text into an edit box
 
-	fmt::vector form(fmt::param, fmt::view text = "", fmt::view title = "");
+	fmt::lines form(fmt::param, fmt::view text = "", fmt::view title = "");
 	// User enters data into a form
 
-	fmt::vector show(fmt::view text, fmt::view type = "info");
+	fmt::lines show(fmt::view text, fmt::view type = "info");
 	// Show a message box with buttons
 
-	fmt::vector text(fmt::view path, fmt::view check = "", fmt::view font = "", fmt::view type = "");
+	fmt::lines text(fmt::view path, fmt::view check = "", fmt::view font = "", fmt::view type = "");
 	// Show text file contents (like a EULA with checkbox)
 
-	fmt::vector select(fmt::view start = "", fmt::view mode = "");
+	fmt::lines select(fmt::view start = "", fmt::view mode = "");
 	// User selects file(s) from the system
 }
 
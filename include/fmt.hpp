@@ -4,6 +4,7 @@
 #include "fwd.hpp"
 #include "tmp.hpp"
 #include "ptr.hpp"
+#include <cstdint>
 
 namespace fmt
 {
@@ -87,9 +88,14 @@ namespace fmt
 		using pair = fwd::pair<Type>;
 		using set = fwd::set<Type, Order, Alloc>;
 		using map = fwd::map<Type, Type, Order, Alloc>;
+		using hash_set = fwd::hash_set<Type, fwd::hash, fwd::equal, Alloc>;
+		using hash_map = fwd::hash_map<Type, Type, fwd::hash, fwd::equal, Alloc>;
+		using flat_set = fwd::flat_set<Type, Order, Alloc>;
+		using flat_map = fwd::flat_map<Type, Type, Order, Alloc>;
 		using init = fwd::init<Type>;
 		using vector = fwd::vector<Type, Alloc>;
 		using span = fwd::span<Type>;
+		using const_span = fwd::span<const Type>;
 		using matrix = fwd::matrix<Type, Alloc>;
 		using base = fwd::base<Type>;
 		using param = fwd::param<Type>;
@@ -212,6 +218,7 @@ namespace fmt
 	using pointer = view::const_pointer;
 	using vector = view::vector;
 	using span = view::span;
+	using const_span = view::const_span;
 	using matrix = view::matrix;
 	using base = view::base;
 	using edges = view::edges;
@@ -242,6 +249,24 @@ namespace fmt
 	constexpr auto npos = view::npos;
 	constexpr size_type null = 0;
 
+	struct atom
+	// Interned string by its 32-bit id, so equal ids mean equal text
+	{
+		std::uint32_t id = 0; // empty
+
+		view str() const;
+		// Interned text for this id
+
+		operator view() const
+		{
+			return str();
+		}
+
+		auto operator<=>(const atom&) const = default;
+	};
+
+	using atoms = fwd::pair<atom>;
+
 	namespace tag
 	{
 		inline view empty = "";
@@ -257,12 +282,23 @@ namespace fmt
 		inline view assign = "=";
 
 		view emplace(view);
+		atom intern(view);
+		atom find(view); // empty if never interned
+		view find(atom);
 
 		input read(input, view = eol);
 		output write(output, view = eol);
 	}
 }
 
+template <> struct std::hash<fmt::atom>
+{
+	std::size_t operator()(fmt::atom a) const noexcept
+	{
+		return std::hash<std::uint32_t>()(a.id);
+	}
+};
+
 inline fmt::input operator>>(fmt::input in, fmt::read read)
 {
 	return read(in);
@@ -0,0 +1,255 @@
+#ifndef format_hpp
+#define format_hpp "Format Strings"
+
+#include "build.hpp"
+#include <array>
+#include <ctime>
+#include <tuple>
+#include <utility>
+
+namespace fmt
+{
+	template <std::size_t N> struct literal
+	// String literal as a template argument
+	{
+		char data[N] { };
+
+		constexpr literal(const char (&s)[N])
+		{
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				data[i] = s[i];
+			}
+		}
+
+		constexpr std::string_view get() const
+		{
+			return { data, N - 1 };
+		}
+	};
+
+	namespace form
+	{
+		struct op
+		// A run of literal text or one argument with its spec
+		{
+			std::size_t pos = 0, size = 0; // in the format string
+			int arg = -1; // literal when negative
+		};
+
+		struct plan
+		// Shape of a format string found by a first pass
+		{
+			std::size_t ops = 0;
+			std::size_t args = 0;
+			bool valid = true;
+		};
+
+		constexpr plan scan(std::string_view u, op* out)
+		// Split $u into operations, storing them in $out unless it is null
+		{
+			plan p;
+			auto emit = [&](std::size_t pos, std::size_t size, int arg)
+			{
+				if (nullptr != out)
+				{
+					out[p.ops] = { pos, size, arg };
+				}
+				++ p.ops;
+			};
+
+			std::size_t text = 0;
+			for (std::size_t i = 0; i < u.size(); )
+			{
+				const auto c = u[i];
+				if ('{' != c and '}' != c)
+				{
+					++ i;
+					continue;
+				}
+				// Doubled braces stand for themselves
+				if (i + 1 < u.size() and c == u[i + 1])
+				{
+					emit(text, i + 1 - text, -1);
+					text = i += 2;
+					continue;
+				}
+				// By hand since GCC cannot run find on a template argument
+				auto end = i;
+				while (end < u.size() and '}' != u[end])
+				{
+					++ end;
+				}
+				if ('}' == c or u.size() == end)
+				{
+					p.valid = false;
+					break;
+				}
+				// Only {} or {:spec}, arguments are taken in order
+				const auto field = u.substr(i + 1, end - i - 1);
+				if (not field.empty() and ':' != field.front())
+				{
+					p.valid = false;
+					break;
+				}
+				if (text < i)
+				{
+					emit(text, i - text, -1);
+				}
+				const auto spec = field.empty() ? 0 : field.size() - 1;
+				emit(i + 2, spec, static_cast<int>(p.args ++));
+				text = i = end + 1;
+			}
+			if (text < u.size())
+			{
+				emit(text, u.size() - text, -1);
+			}
+			return p;
+		}
+
+		struct spec
+		// Options after the colon for numbers
+		{
+			int base = 10;
+			int precision = -1;
+			bool valid = true;
+		};
+
+		constexpr spec options(std::string_view u)
+		// Either one of d, x, o, b or a precision as .N
+		{
+			spec s;
+			if (u.empty())
+			{
+				return s;
+			}
+			else
+			if (1 == u.size() and u.front() != '.')
+			{
+				switch (u.front())
+				{
+				case 'd': s.base = 10; break;
+				case 'x': s.base = 16; break;
+				case 'o': s.base = 8; break;
+				case 'b': s.base = 2; break;
+				default: s.valid = false;
+				}
+			}
+			else
+			if ('.' == u.front() and 1 < u.size())
+			{
+				s.precision = 0;
+				for (const auto c : u.substr(1))
+				{
+					if (c < '0' or '9' < c)
+					{
+						s.valid = false;
+						break;
+					}
+					s.precision = 10 * s.precision + (c - '0');
+				}
+			}
+			else
+			{
+				s.valid = false;
+			}
+			return s;
+		}
+
+		template <literal F> struct parsed
+		{
+			static constexpr plan shape = scan(F.get(), nullptr);
+
+			static constexpr auto ops = []
+			{
+				std::array<op, shape.ops> t { };
+				(void) scan(F.get(), t.data());
+				return t;
+			}();
+		};
+
+		template <literal F, std::size_t I> constexpr auto terminated()
+		// Spec of operation $I as a C string for strftime
+		{
+			constexpr auto at = parsed<F>::ops[I];
+			std::array<char, at.size + 1> z { };
+			for (std::size_t i = 0; i < at.size; ++i)
+			{
+				z[i] = F.data[at.pos + i];
+			}
+			return z;
+		}
+
+		template <literal F, std::size_t I, class Arg> void put(builder& out, const Arg& arg)
+		{
+			using T = std::decay_t<Arg>;
+			constexpr auto at = parsed<F>::ops[I];
+			constexpr auto u = F.get().substr(at.pos, at.size);
+			constexpr auto s = options(u);
+
+			if constexpr (std::is_base_of<std::tm, T>::value)
+			{
+				static_assert(0 < at.size, "Dates need a strftime spec");
+				static constexpr auto z = terminated<F, I>();
+				char buf[256];
+				const auto n = std::strftime(buf, sizeof buf, z.data(), &arg);
+				out.append(std::string_view(buf, n));
+			}
+			else
+			if constexpr (std::is_floating_point<T>::value)
+			{
+				static_assert(s.valid and 10 == s.base, "Numbers take a precision");
+				out.append(arg, s.precision < 0 ? 6 : s.precision);
+			}
+			else
+			if constexpr (builder::number<T>)
+			{
+				static_assert(s.valid and s.precision < 0, "Integers take a base");
+				out.append(arg, s.base);
+			}
+			else
+			{
+				static_assert(u.empty(), "Text takes no spec");
+				static_assert(requires { out << arg; }, "Argument cannot be formatted");
+				out << arg;
+			}
+		}
+
+		template <literal F, std::size_t I, class Tuple> void emit(builder& out, const Tuple& args)
+		{
+			constexpr auto at = parsed<F>::ops[I];
+			if constexpr (at.arg < 0)
+			{
+				out.append(F.get().substr(at.pos, at.size));
+			}
+			else
+			{
+				put<F, I>(out, std::get<at.arg>(args));
+			}
+		}
+	}
+
+	template <literal F, class... Args> builder& format_to(builder& out, const Args&... args)
+	// Write $args into $out as laid out by $F, checked when compiled
+	{
+		using plan = form::parsed<F>;
+		static_assert(plan::shape.valid, "Unmatched brace in format");
+		static_assert(plan::shape.args == sizeof...(Args), "Wrong number of arguments for format");
+
+		const auto tuple = std::forward_as_tuple(args...);
+		[&]<std::size_t... I>(std::index_sequence<I...>)
+		{
+			(form::emit<F, I>(out, tuple), ...);
+		}
+		(std::make_index_sequence<plan::ops.size()>());
+		return out;
+	}
+
+	template <literal F, class... Args> std::string format(const Args&... args)
+	{
+		builder buf;
+		return format_to<F>(buf, args...).str();
+	}
+}
+
+#endif // file
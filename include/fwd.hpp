@@ -17,6 +17,15 @@
 #include <sstream>
 #include <string_view>
 #include <locale>
+#include <memory>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 enum : bool { success = false, failure = true };
 
@@ -205,6 +214,1011 @@ namespace fwd
 	{
 		using Type::Type;
 	};
+
+	//
+	// Open addressing hash tables
+	//
+
+	inline void mum(std::uint64_t& a, std::uint64_t& b)
+	// Low and high words of the full product of $a and $b
+	{
+		#ifdef __SIZEOF_INT128__
+		__extension__ typedef unsigned __int128 u128;
+		const auto r = static_cast<u128>(a) * b;
+		a = static_cast<std::uint64_t>(r);
+		b = static_cast<std::uint64_t>(r >> 64);
+		#else
+		const std::uint64_t ha = a >> 32, la = static_cast<std::uint32_t>(a);
+		const std::uint64_t hb = b >> 32, lb = static_cast<std::uint32_t>(b);
+		const auto hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+		const auto mid = (ll >> 32) + static_cast<std::uint32_t>(hl) + static_cast<std::uint32_t>(lh);
+		a = (mid << 32) | static_cast<std::uint32_t>(ll);
+		b = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+		#endif
+	}
+
+	inline std::uint64_t mix(std::uint64_t a, std::uint64_t b)
+	{
+		mum(a, b);
+		return a ^ b;
+	}
+
+	inline std::uint64_t hash_bytes(const void* data, size_t n)
+	// Short input variant of wyhash (Wang Yi, public domain)
+	{
+		constexpr std::uint64_t s0 = 0xa0761d6478bd642f, s1 = 0xe7037ed1a0b428db;
+		const auto p = static_cast<const unsigned char*>(data);
+		const auto read = [p](size_t i, size_t k)
+		{
+			std::uint64_t w = 0;
+			std::memcpy(&w, p + i, k);
+			return w;
+		};
+
+		auto seed = mix(s0, s1);
+		std::uint64_t a = 0, b = 0;
+		if (n <= 16)
+		{
+			if (4 <= n)
+			{
+				const auto d = (n >> 3) << 2;
+				a = read(0, 4) << 32 | read(d, 4);
+				b = read(n - 4, 4) << 32 | read(n - 4 - d, 4);
+			}
+			else
+			if (0 < n)
+			{
+				a = std::uint64_t(p[0]) << 16 | std::uint64_t(p[n >> 1]) << 8 | p[n - 1];
+			}
+		}
+		else
+		{
+			for (size_t i = 0; 16 < n - i; i += 16)
+			{
+				seed = mix(read(i, 8) ^ s1, read(i + 8, 8) ^ seed);
+			}
+			a = read(n - 16, 8);
+			b = read(n - 8, 8);
+		}
+		a ^= s1;
+		b ^= seed;
+		mum(a, b);
+		return mix(a ^ s0 ^ n, b ^ s1);
+	}
+
+	template <class Char> constexpr bool is_char = false;
+	template <> inline constexpr bool is_char<char> = true;
+	template <> inline constexpr bool is_char<wchar_t> = true;
+	template <> inline constexpr bool is_char<char8_t> = true;
+	template <> inline constexpr bool is_char<char16_t> = true;
+	template <> inline constexpr bool is_char<char32_t> = true;
+
+	template <class Type> struct hash
+	// Transparent hash where any string agrees with its view
+	{
+		using is_transparent = void;
+
+		template <class Key> size_t operator()(const Key& key) const
+		{
+			using Bare = std::remove_cv_t<std::remove_pointer_t<std::decay_t<Key>>>;
+			if constexpr (std::is_pointer<std::decay_t<Key>>::value and is_char<Bare>)
+			{
+				return (*this)(std::basic_string_view<Bare>(key));
+			}
+			else
+			if constexpr (requires { key.data(); key.size(); typename Key::traits_type; })
+			{
+				using Char = typename Key::value_type;
+				return static_cast<size_t>(hash_bytes(key.data(), key.size() * sizeof(Char)));
+			}
+			else
+			if constexpr (requires { key.first; key.second; })
+			{
+				using First = std::decay_t<decltype(key.first)>;
+				using Second = std::decay_t<decltype(key.second)>;
+				const auto a = hash<First>()(key.first);
+				const auto b = hash<Second>()(key.second);
+				return static_cast<size_t>(mix(a, b ^ 0x9e3779b97f4a7c15));
+			}
+			else
+			{
+				// Integers often hash to themselves, so spread the bits
+				const auto h = std::hash<Type>()(key);
+				return static_cast<size_t>(mix(h ^ 0xa0761d6478bd642f, 0xe7037ed1a0b428db));
+			}
+		}
+	};
+
+	template <class Type> struct equal : std::equal_to<>
+	// Transparent comparison to go with hash
+	{ };
+
+	struct group
+	// Control bytes probed together, each empty, deleted or seven bits of hash
+	{
+		using ctrl = std::int8_t;
+		static constexpr ctrl empty = -128, deleted = -2;
+
+		#ifdef __SSE2__
+
+		using mask = unsigned;
+		static constexpr size_t width = 16;
+		__m128i x;
+
+		explicit group(const ctrl* p)
+		: x(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+		{ }
+
+		mask match(ctrl h) const
+		{
+			return static_cast<mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), x)));
+		}
+
+		mask free() const
+		// Empty or deleted have the high bit set
+		{
+			return static_cast<mask>(_mm_movemask_epi8(x));
+		}
+
+		static size_t index(mask m)
+		{
+			return std::countr_zero(m);
+		}
+
+		static mask rest(mask m)
+		// Drop the first position of $m
+		{
+			return m & (m - 1);
+		}
+
+		#else
+
+		using mask = std::uint64_t;
+		static constexpr size_t width = 8;
+		static constexpr mask lsb = 0x0101010101010101, msb = 0x8080808080808080;
+		mask x;
+
+		explicit group(const ctrl* p)
+		{
+			std::memcpy(&x, p, sizeof x);
+		}
+
+		mask match(ctrl h) const
+		// May flag a full byte after a match, so keys must still be compared
+		{
+			const auto y = x ^ (lsb * static_cast<std::uint8_t>(h));
+			return (y - lsb) & ~y & msb;
+		}
+
+		mask free() const
+		{
+			return x & msb;
+		}
+
+		// First slot is the low byte of a little endian load
+		static constexpr bool little = std::endian::native == std::endian::little;
+
+		static size_t index(mask m)
+		{
+			return (little ? std::countr_zero(m) : std::countl_zero(m)) / 8;
+		}
+
+		static mask rest(mask m)
+		{
+			return little ? m & (m - 1) : m & ~(msb >> (8 * index(m)));
+		}
+
+		#endif
+
+		mask vacant() const
+		{
+			return match(empty);
+		}
+	};
+
+	template <class Slot, class Key, class Hash, class Equal, class Alloc> class hash_table
+	// Slots kept flat in an array and found by a parallel scan of their control bytes
+	{
+	public:
+
+		using key_type = Key;
+		using value_type = Slot;
+		using size_type = size_t;
+
+		template <bool Const> class cursor
+		{
+			friend class hash_table;
+			template <bool> friend class cursor;
+			using table = std::conditional_t<Const, const hash_table, hash_table>;
+
+			table* that = nullptr;
+			size_t at = 0;
+
+			cursor(table* t, size_t n)
+			: that(t), at(n)
+			{ }
+
+		public:
+
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Slot;
+			using difference_type = std::ptrdiff_t;
+			using reference = std::conditional_t<Const, const Slot&, Slot&>;
+			using pointer = std::conditional_t<Const, const Slot*, Slot*>;
+
+			cursor() = default;
+
+			template <bool Other> cursor(const cursor<Other>& it) requires (Const and not Other)
+			: that(it.that), at(it.at)
+			{ }
+
+			reference operator*() const
+			{
+				return that->slots[at];
+			}
+
+			pointer operator->() const
+			{
+				return that->slots + at;
+			}
+
+			cursor& operator++()
+			{
+				at = that->seek(at + 1);
+				return *this;
+			}
+
+			cursor operator++(int)
+			{
+				auto it = *this;
+				++ *this;
+				return it;
+			}
+
+			bool operator==(const cursor& it) const
+			{
+				return at == it.at;
+			}
+		};
+
+		// Keys in a set must not change through an iterator
+		using iterator = cursor<std::is_same<Slot, Key>::value>;
+		using const_iterator = cursor<true>;
+
+		hash_table() = default;
+
+		hash_table(const hash_table& that)
+		: hasher(that.hasher), equals(that.equals), alloc(that.alloc)
+		{
+			reserve(that.used);
+			for (const auto& s : that)
+			{
+				(void) insert_with(key_of(s), [&](Slot* p)
+				{
+					traits::construct(alloc, p, s);
+				});
+			}
+		}
+
+		hash_table(hash_table&& that) noexcept
+		{
+			swap(that);
+		}
+
+		hash_table& operator=(hash_table that) noexcept
+		{
+			swap(that);
+			return *this;
+		}
+
+		~hash_table()
+		{
+			clear();
+			if (nullptr != slots)
+			{
+				traits::deallocate(alloc, slots, cap);
+			}
+		}
+
+		void swap(hash_table& that) noexcept
+		{
+			std::swap(ctrls, that.ctrls);
+			std::swap(slots, that.slots);
+			std::swap(cap, that.cap);
+			std::swap(used, that.used);
+			std::swap(room, that.room);
+			std::swap(hasher, that.hasher);
+			std::swap(equals, that.equals);
+			std::swap(alloc, that.alloc);
+		}
+
+		size_t size() const
+		{
+			return used;
+		}
+
+		bool empty() const
+		{
+			return 0 == used;
+		}
+
+		iterator begin()
+		{
+			return { this, seek(0) };
+		}
+
+		iterator end()
+		{
+			return { this, cap };
+		}
+
+		const_iterator begin() const
+		{
+			return { this, seek(0) };
+		}
+
+		const_iterator end() const
+		{
+			return { this, cap };
+		}
+
+		template <class K> iterator find(const K& key)
+		{
+			return { this, locate(key, hasher(key)) };
+		}
+
+		template <class K> const_iterator find(const K& key) const
+		{
+			return { this, locate(key, hasher(key)) };
+		}
+
+		template <class K> bool contains(const K& key) const
+		{
+			return locate(key, hasher(key)) < cap;
+		}
+
+		template <class K> size_t count(const K& key) const
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+		template <class K> size_t erase(const K& key)
+		requires (not std::is_convertible<const K&, const_iterator>::value)
+		{
+			const auto i = locate(key, hasher(key));
+			if (cap <= i)
+			{
+				return 0;
+			}
+			drop(i);
+			return 1;
+		}
+
+		iterator erase(const_iterator it)
+		{
+			drop(it.at);
+			return { this, seek(it.at + 1) };
+		}
+
+		void clear()
+		{
+			for (size_t i = 0; i < cap; ++i)
+			{
+				if (0 <= ctrls[i])
+				{
+					traits::destroy(alloc, slots + i);
+				}
+			}
+			std::fill_n(ctrls.get(), cap, group::empty);
+			used = 0;
+			room = cap - cap / 8;
+		}
+
+		void reserve(size_t n)
+		// Room for $n slots without growing
+		{
+			const auto m = std::bit_ceil(std::max(group::width, n + n / 7 + 1));
+			if (cap < m)
+			{
+				rehash(m);
+			}
+		}
+
+	protected:
+
+		using traits = std::allocator_traits<Alloc>;
+		using ctrl = group::ctrl;
+
+		std::unique_ptr<ctrl[]> ctrls;
+		Slot* slots = nullptr;
+		size_t cap = 0, used = 0, room = 0;
+		[[no_unique_address]] Hash hasher;
+		[[no_unique_address]] Equal equals;
+		[[no_unique_address]] Alloc alloc;
+
+		static const Key& key_of(const Slot& s)
+		{
+			if constexpr (std::is_same<Slot, Key>::value)
+			{
+				return s;
+			}
+			else
+			{
+				return s.first;
+			}
+		}
+
+		size_t seek(size_t n) const
+		// First full slot from $n or the end
+		{
+			while (n < cap and ctrls[n] < 0)
+			{
+				++ n;
+			}
+			return n;
+		}
+
+		template <class K> size_t locate(const K& key, size_t h) const
+		// Slot holding $key or the end
+		{
+			if (0 == cap)
+			{
+				return cap;
+			}
+			// Triangular steps over a power of two visit every group
+			const auto last = cap / group::width - 1;
+			for (size_t g = (h >> 7) & last, step = 1; ; g = (g + step++) & last)
+			{
+				const auto base = g * group::width;
+				const group x(ctrls.get() + base);
+				for (auto m = x.match(h & 0x7F); m; m = group::rest(m))
+				{
+					const auto i = base + group::index(m);
+					if (equals(key_of(slots[i]), key))
+					{
+						return i;
+					}
+				}
+				if (x.vacant())
+				{
+					return cap;
+				}
+			}
+		}
+
+		size_t vacancy(size_t h) const
+		// First empty or deleted slot along the probe for $h
+		{
+			const auto last = cap / group::width - 1;
+			for (size_t g = (h >> 7) & last, step = 1; ; g = (g + step++) & last)
+			{
+				const auto base = g * group::width;
+				if (const auto m = group(ctrls.get() + base).free())
+				{
+					return base + group::index(m);
+				}
+			}
+		}
+
+		template <class K, class Make> std::pair<iterator, bool> insert_with(const K& key, Make make)
+		// Find $key or else build a slot for it in place with $make
+		{
+			const size_t h = hasher(key);
+			if (const auto i = locate(key, h); i < cap)
+			{
+				return { iterator(this, i), false };
+			}
+			if (0 == room)
+			{
+				// Reclaim deleted slots unless the table is really full
+				rehash(std::max(group::width, used < cap / 2 ? cap : 2 * cap));
+			}
+			const auto i = vacancy(h);
+			make(slots + i);
+			room -= group::empty == ctrls[i];
+			ctrls[i] = static_cast<ctrl>(h & 0x7F);
+			++ used;
+			return { iterator(this, i), true };
+		}
+
+		void drop(size_t i)
+		// Destroy slot $i leaving it empty when no probe can pass its group
+		{
+			traits::destroy(alloc, slots + i);
+			const auto base = i - i % group::width;
+			if (group(ctrls.get() + base).vacant())
+			{
+				ctrls[i] = group::empty;
+				++ room;
+			}
+			else
+			{
+				ctrls[i] = group::deleted;
+			}
+			-- used;
+		}
+
+		void rehash(size_t n)
+		// Move every slot into a table of $n
+		{
+			auto old = std::move(ctrls);
+			const auto from = slots;
+			const auto size = cap;
+
+			ctrls.reset(new ctrl[n]);
+			std::fill_n(ctrls.get(), n, group::empty);
+			slots = traits::allocate(alloc, n);
+			cap = n;
+			room = n - n / 8 - used;
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				if (0 <= old[i])
+				{
+					const size_t h = hasher(key_of(from[i]));
+					const auto j = vacancy(h);
+					traits::construct(alloc, slots + j, std::move(from[i]));
+					traits::destroy(alloc, from + i);
+					ctrls[j] = static_cast<ctrl>(h & 0x7F);
+				}
+			}
+			if (nullptr != from)
+			{
+				traits::deallocate(alloc, from, size);
+			}
+		}
+	};
+
+	template
+	<
+		class Key
+		,
+		template <class> class Hash = hash
+		,
+		template <class> class Equal = equal
+		,
+		template <class> class Alloc = std::allocator
+	>
+	class hash_set : public hash_table<Key, Key, Hash<Key>, Equal<Key>, Alloc<Key>>
+	{
+		using base = hash_table<Key, Key, Hash<Key>, Equal<Key>, Alloc<Key>>;
+		using typename base::traits;
+
+	public:
+
+		using typename base::iterator;
+
+		hash_set() = default;
+
+		hash_set(init<Key> t)
+		{
+			base::reserve(t.size());
+			for (const auto& k : t)
+			{
+				(void) insert(k);
+			}
+		}
+
+		std::pair<iterator, bool> insert(const Key& key)
+		{
+			return base::insert_with(key, [&](Key* p)
+			{
+				traits::construct(base::alloc, p, key);
+			});
+		}
+
+		std::pair<iterator, bool> insert(Key&& key)
+		{
+			return base::insert_with(key, [&](Key* p)
+			{
+				traits::construct(base::alloc, p, std::move(key));
+			});
+		}
+
+		template <class... Args> std::pair<iterator, bool> emplace(Args&&... args)
+		{
+			return insert(Key(std::forward<Args>(args)...));
+		}
+	};
+
+	template
+	<
+		class Key
+		,
+		class Value
+		,
+		template <class> class Hash = hash
+		,
+		template <class> class Equal = equal
+		,
+		template <class> class Alloc = std::allocator
+	>
+	class hash_map : public hash_table<std::pair<const Key, Value>, Key, Hash<Key>, Equal<Key>, Alloc<std::pair<const Key, Value>>>
+	{
+		using slot = std::pair<const Key, Value>;
+		using base = hash_table<slot, Key, Hash<Key>, Equal<Key>, Alloc<slot>>;
+		using typename base::traits;
+
+	public:
+
+		using typename base::iterator;
+		using mapped_type = Value;
+
+		hash_map() = default;
+
+		hash_map(init<slot> t)
+		{
+			base::reserve(t.size());
+			for (const auto& s : t)
+			{
+				(void) insert(s);
+			}
+		}
+
+		template <class K, class... Args> std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+		// Build the value from $args only when $key is missing
+		{
+			return base::insert_with(key, [&](slot* p)
+			{
+				traits::construct(base::alloc, p, std::piecewise_construct,
+					std::forward_as_tuple(std::forward<K>(key)),
+					std::forward_as_tuple(std::forward<Args>(args)...));
+			});
+		}
+
+		template <class K, class V> std::pair<iterator, bool> emplace(K&& key, V&& value)
+		{
+			return try_emplace(std::forward<K>(key), std::forward<V>(value));
+		}
+
+		std::pair<iterator, bool> insert(const slot& s)
+		{
+			return try_emplace(s.first, s.second);
+		}
+
+		template <class K> Value& operator[](K&& key)
+		{
+			return try_emplace(std::forward<K>(key)).first->second;
+		}
+
+		Value& operator[](const Key& key)
+		{
+			return try_emplace(key).first->second;
+		}
+
+		Value& operator[](Key&& key)
+		{
+			return try_emplace(std::move(key)).first->second;
+		}
+	};
+
+	//
+	// Sorted vector tables
+	//
+
+	template <class It, class Key, class Less> constexpr It bisect(It first, size_t n, const Key& key, Less less)
+	// Lower bound for $key in $n sorted items from $first with no branch in the loop
+	{
+		while (1 < n)
+		{
+			const auto half = n / 2;
+			first = less(first[half - 1], key) ? first + half : first;
+			n -= half;
+		}
+		return first + (0 < n and less(*first, key));
+	}
+
+	template <class Slot, class Key, class Order, class Alloc> class flat_table
+	// Items kept sorted by key in one vector, built in bulk then searched
+	{
+	public:
+
+		using key_type = Key;
+		using value_type = Slot;
+		using size_type = size_t;
+		using container = std::vector<Slot, Alloc>;
+		using iterator = typename container::iterator;
+		using const_iterator = typename container::const_iterator;
+
+		flat_table() = default;
+
+		flat_table(container t)
+		: items(std::move(t))
+		{
+			order();
+		}
+
+		flat_table(init<Slot> t)
+		: items(t)
+		{
+			order();
+		}
+
+		template <class It> flat_table(It begin, It end)
+		: items(begin, end)
+		{
+			order();
+		}
+
+		size_t size() const
+		{
+			return items.size();
+		}
+
+		bool empty() const
+		{
+			return items.empty();
+		}
+
+		void clear()
+		{
+			items.clear();
+		}
+
+		void reserve(size_t n)
+		{
+			items.reserve(n);
+		}
+
+		iterator begin()
+		{
+			return items.begin();
+		}
+
+		iterator end()
+		{
+			return items.end();
+		}
+
+		const_iterator begin() const
+		{
+			return items.begin();
+		}
+
+		const_iterator end() const
+		{
+			return items.end();
+		}
+
+		iterator lower_bound(const Key& key)
+		{
+			return begin() + position(key);
+		}
+
+		const_iterator lower_bound(const Key& key) const
+		{
+			return begin() + position(key);
+		}
+
+		iterator find(const Key& key)
+		{
+			const auto pos = position(key);
+			return found(pos, key) ? begin() + pos : end();
+		}
+
+		const_iterator find(const Key& key) const
+		{
+			const auto pos = position(key);
+			return found(pos, key) ? begin() + pos : end();
+		}
+
+		bool contains(const Key& key) const
+		{
+			return found(position(key), key);
+		}
+
+		size_t count(const Key& key) const
+		{
+			return contains(key) ? 1 : 0;
+		}
+
+		size_t erase(const Key& key)
+		{
+			const auto pos = position(key);
+			if (not found(pos, key))
+			{
+				return 0;
+			}
+			(void) items.erase(begin() + pos);
+			return 1;
+		}
+
+		iterator erase(const_iterator it)
+		{
+			return items.erase(it);
+		}
+
+	protected:
+
+		container items;
+		[[no_unique_address]] Order less;
+
+		static const Key& key_of(const Slot& s)
+		{
+			if constexpr (std::is_same<Slot, Key>::value)
+			{
+				return s;
+			}
+			else
+			{
+				return s.first;
+			}
+		}
+
+		size_t position(const Key& key) const
+		{
+			const auto before = [this](const Slot& s, const Key& k)
+			{
+				return less(key_of(s), k);
+			};
+			return bisect(items.begin(), items.size(), key, before) - items.begin();
+		}
+
+		bool found(size_t pos, const Key& key) const
+		{
+			return pos < items.size() and not less(key, key_of(items[pos]));
+		}
+
+		template <class Make> std::pair<iterator, bool> insert_with(const Key& key, Make make)
+		// Find $key or else put the item from $make in order, which is linear
+		{
+			const auto pos = position(key);
+			if (found(pos, key))
+			{
+				return { begin() + pos, false };
+			}
+			return { items.insert(begin() + pos, make()), true };
+		}
+
+		void order()
+		// Sort by key keeping the first of equal keys
+		{
+			const auto by = [this](const Slot& a, const Slot& b)
+			{
+				return less(key_of(a), key_of(b));
+			};
+			const auto same = [this](const Slot& a, const Slot& b)
+			{
+				return not less(key_of(a), key_of(b)) and not less(key_of(b), key_of(a));
+			};
+			std::stable_sort(items.begin(), items.end(), by);
+			(void) items.erase(std::unique(items.begin(), items.end(), same), items.end());
+		}
+	};
+
+	template
+	<
+		class Key
+		,
+		template <class> class Order = std::less
+		,
+		template <class> class Alloc = std::allocator
+	>
+	class flat_set : public flat_table<Key, Key, Order<Key>, Alloc<Key>>
+	{
+		using base = flat_table<Key, Key, Order<Key>, Alloc<Key>>;
+
+	public:
+
+		using typename base::iterator;
+		using base::base;
+
+		std::pair<iterator, bool> insert(const Key& key)
+		{
+			return base::insert_with(key, [&]
+			{
+				return key;
+			});
+		}
+	};
+
+	template
+	<
+		class Key
+		,
+		class Value
+		,
+		template <class> class Order = std::less
+		,
+		template <class> class Alloc = std::allocator
+	>
+	class flat_map : public flat_table<pair<Key, Value>, Key, Order<Key>, Alloc<pair<Key, Value>>>
+	{
+		using slot = pair<Key, Value>;
+		using base = flat_table<slot, Key, Order<Key>, Alloc<slot>>;
+
+	public:
+
+		using typename base::iterator;
+		using mapped_type = Value;
+		using base::base;
+
+		template <class... Args> std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+		{
+			return base::insert_with(key, [&]
+			{
+				return slot(std::piecewise_construct,
+					std::forward_as_tuple(key),
+					std::forward_as_tuple(std::forward<Args>(args)...));
+			});
+		}
+
+		std::pair<iterator, bool> insert(const slot& s)
+		{
+			return try_emplace(s.first, s.second);
+		}
+
+		Value& operator[](const Key& key)
+		{
+			return try_emplace(key).first->second;
+		}
+	};
+
+	template <class Key, class Value, size_t Size, class Order = std::less<>> class static_map
+	// Sorted when compiled for constant tables
+	{
+		using slot = pair<Key, Value>;
+		std::array<slot, Size> items;
+
+		static constexpr auto by = [](const slot& a, const slot& b)
+		{
+			return Order()(a.first, b.first);
+		};
+
+	public:
+
+		using key_type = Key;
+		using mapped_type = Value;
+		using value_type = slot;
+		using const_iterator = const slot*;
+
+		constexpr static_map(const slot (&t)[Size])
+		: items(std::to_array(t))
+		{
+			std::sort(items.begin(), items.end(), by);
+		}
+
+		constexpr size_t size() const
+		{
+			return Size;
+		}
+
+		constexpr const_iterator begin() const
+		{
+			return items.data();
+		}
+
+		constexpr const_iterator end() const
+		{
+			return items.data() + Size;
+		}
+
+		template <class K> constexpr const_iterator find(const K& key) const
+		{
+			const auto before = [](const slot& s, const K& k)
+			{
+				return Order()(s.first, k);
+			};
+			const auto it = bisect(begin(), Size, key, before);
+			return it != end() and not Order()(key, it->first) ? it : end();
+		}
+
+		template <class K> constexpr bool contains(const K& key) const
+		{
+			return find(key) != end();
+		}
+
+		constexpr bool unique() const
+		// No two keys are equal, which a table may check with static_assert
+		{
+			return std::adjacent_find(items.begin(), items.end(), [](const slot& a, const slot& b)
+			{
+				return not by(a, b);
+			}) == items.end();
+		}
+	};
+
+	template <class Key, class Value, size_t Size> static_map(const pair<Key, Value> (&)[Size]) -> static_map<Key, Value, Size>;
 }
 
 #endif // file
@@ -8,8 +8,16 @@ namespace doc
 	struct ini : fmt::memory<ini>
 	{
 		fwd::map<fmt::pair, fmt::view> keys;
+		fwd::hash_map<fmt::atoms, fmt::view*> index; // into keys
 		fmt::string::set cache;
 
+		ini() = default;
+		ini(ini&&) = default;
+		ini& operator=(ini&&) = default;
+		ini(const ini&) = delete;
+		ini& operator=(const ini&) = delete;
+		// A copy would index the nodes of the source keys
+
 		friend fmt::input operator>>(fmt::input, ref);
 		friend fmt::output operator<<(fmt::output, cref);
 		static fmt::input getline(fmt::input, fmt::string::ref);
@@ -18,6 +26,12 @@ namespace doc
 		fmt::view get(fmt::pair) const;
 		bool set(fmt::pair, fmt::view);
 		bool put(fmt::pair, fmt::view);
+
+		bool got(fmt::atoms) const;
+		fmt::view get(fmt::atoms) const;
+		bool set(fmt::atoms, fmt::view);
+		bool put(fmt::atoms, fmt::view);
+		// Same as above with interned keys compared by id
 	};
 }
 
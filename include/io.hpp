@@ -3,10 +3,13 @@
 
 #include <streambuf>
 #include "file.hpp"
+#include "sys.hpp"
 #include "dig.hpp"
 #include "fwd.hpp"
 #include "ptr.hpp"
 #include "tmp.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 
 namespace fmt
@@ -152,36 +155,372 @@ namespace fmt
 	<
 		class Char,
 		template <class> class Traits = std::char_traits,
-		template <class> class Alloc = std::allocator
+		template <class> class Alloc = std::allocator,
+		// details
+		class Base = fwd::basic_buf<Char, Traits>
 	>
-	struct basic_buf : basic_stringbuf<Char, Traits, Alloc>
+	struct basic_fdbuf : Base
+	// Buffer on a file descriptor with system calls so data is copied once
+	// and a large transfer goes with what is buffered in a single call
 	{
-		using Base = basic_stringbuf<Char, Traits, Alloc>;
-		using size_type = typename Base::size_type;
 		using char_type = typename Base::char_type;
+		using traits_type = typename Base::traits_type;
+		using int_type = typename Base::int_type;
+		using off_type = typename Base::off_type;
+		using pos_type = typename Base::pos_type;
+		using size_type = std::streamsize;
+
+		basic_fdbuf(int fd = sys::invalid, size_type n = BUFSIZ)
+		: fd(fd), size(fmt::to_size(std::max<size_type>(n, 1)))
+		{ }
+
+		basic_fdbuf(const basic_fdbuf&) = delete;
+		basic_fdbuf& operator=(const basic_fdbuf&) = delete;
 
-		basic_buf(env::file::shared_ptr that)
+		~basic_fdbuf()
 		{
-			file = that;
+			(void) sync();
 		}
 
-		env::file::shared_ptr file;
+		int descriptor() const
+		// Not closed by the buffer
+		{
+			return fd;
+		}
+
+	protected:
+
+		int_type overflow(int_type c) override
+		{
+			constexpr int_type eof = traits_type::eof();
+			ready();
+			if (traits_type::eq_int_type(eof, c))
+			{
+				return sync() < 0 ? eof : traits_type::not_eof(c);
+			}
+
+			auto ch = traits_type::to_char_type(c);
+			if (Base::pptr() < Base::epptr())
+			{
+				*Base::pptr() = ch;
+				Base::pbump(1);
+				return c;
+			}
+
+			// Full, so the character goes out with the area
+			sys::iovec v[] = { pending(), { &ch, sizeof ch } };
+			if (not send(v, 2))
+			{
+				return eof;
+			}
+			Base::setp(Base::pbase(), Base::epptr());
+			return c;
+		}
+
+		size_type xsputn(const char_type* s, size_type n) override
+		{
+			if (n <= 0)
+			{
+				return 0;
+			}
+			ready();
+			if (n < Base::epptr() - Base::pptr())
+			{
+				traits_type::copy(Base::pptr(), s, fmt::to_size(n));
+				Base::pbump(fmt::to_int(n));
+				return n;
+			}
+
+			// Too much to hold, so write it straight after the area
+			sys::iovec v[] = { pending(), { const_cast<char_type*>(s), bytes(n) } };
+			if (not send(v, 2))
+			{
+				return 0;
+			}
+			Base::setp(Base::pbase(), Base::epptr());
+			return n;
+		}
+
+		int_type underflow() override
+		{
+			constexpr int_type eof = traits_type::eof();
+			if (Base::gptr() < Base::egptr())
+			{
+				return traits_type::to_int_type(*Base::gptr());
+			}
+			if (not yield())
+			{
+				return eof;
+			}
+
+			const auto p = area(0);
+			sys::iovec v[] = { { p, bytes(size) } };
+			const auto k = receive(v, 1);
+			if (k <= 0)
+			{
+				Base::setg(nullptr, nullptr, nullptr);
+				return eof;
+			}
+			Base::setg(p, p, p + k);
+			return traits_type::to_int_type(*p);
+		}
+
+		size_type xsgetn(char_type* s, size_type n) override
+		{
+			auto got = std::min<size_type>(n, Base::egptr() - Base::gptr());
+			if (0 < got)
+			{
+				traits_type::copy(s, Base::gptr(), fmt::to_size(got));
+				Base::gbump(fmt::to_int(got));
+			}
+			if (got == n or not yield())
+			{
+				return got;
+			}
+
+			// The rest of the request then read ahead in the same call
+			const auto p = area(0);
+			sys::iovec v[] = { { s + got, bytes(n - got) }, { p, bytes(size) } };
+			for (;;)
+			{
+				const auto k = receive(v, 2);
+				if (k <= 0)
+				{
+					Base::setg(nullptr, nullptr, nullptr);
+					return got;
+				}
+				if (k < n - got)
+				{
+					got += k;
+					v[0] = { s + got, bytes(n - got) };
+					continue;
+				}
+				Base::setg(p, p, p + (k - (n - got)));
+				return n;
+			}
+		}
+
+		int sync() override
+		{
+			if (Base::pbase() == Base::pptr())
+			{
+				return 0;
+			}
+			sys::iovec v[] = { pending() };
+			if (not send(v, 1))
+			{
+				return -1;
+			}
+			Base::setp(Base::pbase(), Base::epptr());
+			return 0;
+		}
+
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override
+		{
+			constexpr auto width = static_cast<off_type>(sizeof(char_type));
+			const pos_type bad(off_type(-1));
+			if (not yield() or not drop())
+			{
+				return bad;
+			}
+
+			const int whence
+				= std::ios_base::beg == dir ? SEEK_SET
+				: std::ios_base::end == dir ? SEEK_END
+				: SEEK_CUR;
+			const auto at = sys::lseek(fd, static_cast<sys::off_t>(off * width), whence);
+			if (at < 0)
+			{
+				return bad;
+			}
+			return pos_type(off_type(at) / width);
+		}
+
+		pos_type seekpos(pos_type pos, std::ios_base::openmode mode) override
+		{
+			return seekoff(off_type(pos), std::ios_base::beg, mode);
+		}
 
 	private:
 
-		size_type xsputn(char_type const *s, size_type n) override
+		int fd;
+		std::size_t size; // of each area
+		fwd::vector<char_type, Alloc> buf; // get area then put area
+
+		static std::size_t bytes(std::ptrdiff_t n)
+		{
+			return fmt::to_size(n) * sizeof(char_type);
+		}
+
+		char_type* area(std::size_t k)
+		// Start of get or put area, made on first use
+		{
+			if (buf.empty())
+			{
+				buf.resize(2 * size);
+			}
+			return buf.data() + k * size;
+		}
+
+		sys::iovec pending() const
+		{
+			return { Base::pbase(), bytes(Base::pptr() - Base::pbase()) };
+		}
+
+		bool drop()
+		// Give back read ahead so the offset is where the reader is, or keep
+		// it where the descriptor cannot seek, as with a pipe or socket
+		{
+			const auto ahead = Base::egptr() - Base::gptr();
+			if (0 < ahead)
+			{
+				const auto off = -static_cast<sys::off_t>(bytes(ahead));
+				if (sys::lseek(fd, off, SEEK_CUR) < 0)
+				{
+					return false;
+				}
+			}
+			Base::setg(nullptr, nullptr, nullptr);
+			return true;
+		}
+
+		void ready()
+		// Put area after any reading
 		{
-			const auto m = std::fwrite(s, fmt::to_size(n), sizeof(char), file.get());
-			return fmt::to<size_type>(m);
+			if (nullptr == Base::pbase())
+			{
+				(void) drop();
+				const auto p = area(1);
+				Base::setp(p, p + size);
+			}
 		}
 
-		size_type xsgetn(char_type *s, size_type n) override
+		bool yield()
+		// Write and forget the put area before reading
 		{
-			const auto m = std::fread(s, fmt::to_size(n), sizeof(char), file.get());
-			return fmt::to<size_type>(m);
+			if (nullptr != Base::pbase())
+			{
+				if (sync() < 0)
+				{
+					return false;
+				}
+				Base::setp(nullptr, nullptr);
+			}
+			return true;
+		}
+
+		bool send(sys::iovec* v, int n)
+		// Write all of $n vectors at $v, resuming after short writes
+		{
+			while (0 < n)
+			{
+				const auto k = sys::writev(fd, v, n);
+				if (k < 0 and EINTR == errno)
+				{
+					continue;
+				}
+				if (k <= 0)
+				{
+					#ifdef perror
+					perror("writev");
+					#endif
+					return false;
+				}
+				auto m = fmt::to_size(k);
+				for (; 0 < n and v->iov_len <= m; ++v, --n)
+				{
+					m -= v->iov_len;
+				}
+				if (0 < n)
+				{
+					v->iov_base = static_cast<char*>(v->iov_base) + m;
+					v->iov_len -= m;
+				}
+			}
+			return true;
 		}
 
-		using Base::Base;
+		size_type receive(sys::iovec* v, int n)
+		// Read into $n vectors at $v and count whole characters
+		{
+			sys::ssize_t k;
+			do k = sys::readv(fd, v, n);
+			while (k < 0 and EINTR == errno);
+			if (k < 0)
+			{
+				#ifdef perror
+				perror("readv");
+				#endif
+				return k;
+			}
+
+			// Finish a character split by a short read
+			constexpr auto w = sizeof(char_type);
+			for (auto odd = fmt::to_size(k) % w; 0 < odd; odd = fmt::to_size(k) % w)
+			{
+				auto at = fmt::to_size(k);
+				auto u = v;
+				for (; u->iov_len <= at; ++u)
+				{
+					at -= u->iov_len;
+				}
+				const auto p = static_cast<char*>(u->iov_base) + at;
+				const auto m = sys::read(fd, p, static_cast<sys::size_t>(w - odd));
+				if (m <= 0)
+				{
+					k -= static_cast<sys::ssize_t>(odd);
+					break;
+				}
+				k += m;
+			}
+			return k / static_cast<sys::ssize_t>(w);
+		}
+	};
+
+	using fdbuf = basic_fdbuf<char>;
+	using wfdbuf = basic_fdbuf<wchar_t>;
+
+
+	template
+	<
+		class Char,
+		template <class> class Traits = std::char_traits,
+		template <class> class Alloc = std::allocator
+	>
+	struct basic_buf : basic_fdbuf<Char, Traits, Alloc>
+	// Descriptor buffer on a file kept open, which is flushed first and
+	// should not be used through stdio while the buffer is in use
+	{
+		using Base = basic_fdbuf<Char, Traits, Alloc>;
+		using size_type = typename Base::size_type;
+
+		basic_buf(env::file::shared_ptr that, size_type n = BUFSIZ)
+		: Base(descriptor(that.get()), n), file(that)
+		{ }
+
+		basic_buf(int fd, size_type n = BUFSIZ)
+		: Base(fd, n)
+		{ }
+
+		~basic_buf()
+		{
+			// Before the file may close
+			(void) this->sync();
+		}
+
+		env::file::shared_ptr file;
+
+	private:
+
+		static int descriptor(FILE* f)
+		{
+			if (nullptr == f)
+			{
+				return sys::invalid;
+			}
+			(void) std::fflush(f);
+			return sys::fileno(f);
+		}
 	};
 
 	template
@@ -195,13 +534,18 @@ namespace fmt
 	{
 		using stream = Stream<Char, Traits>;
 		using buf = basic_buf<Char, Traits, Alloc>;
+		using size_type = typename buf::size_type;
+
+		basic_stream(env::file::unique_ptr file, size_type n = BUFSIZ)
+		: stream(this), buf(std::move(file), n)
+		{ }
 
-		basic_stream(env::file::unique_ptr file)
-		: stream(this), buf(std::move(file))
+		basic_stream(env::file::shared_ptr file, size_type n = BUFSIZ)
+		: stream(this), buf(file, n)
 		{ }
 
-		basic_stream(env::file::shared_ptr file)
-		: stream(this), buf(file)
+		basic_stream(int fd, size_type n = BUFSIZ)
+		: stream(this), buf(fd, n)
 		{ }
 	};
 
@@ -5,12 +5,16 @@
 #include "tmp.hpp"
 #include "ptr.hpp"
 #include <iterator>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <cstdint>
 
 namespace fwd
 {
-	template <class It> struct range : pair<It>
+	template <class It> struct range : fwd::pair<It>
 	{
-		using pair = pair<It>;
+		using pair = fwd::pair<It>;
 		using pair::pair;
 
 		bool less(It it) const
@@ -67,6 +71,17 @@ namespace fwd
 		{
 			return range(rbegin(), rend());
 		}
+
+		template <class Container> Container& to(Container& c) const
+		// Replace what is in $c with the items in this range
+		{
+			c.clear();
+			for (auto&& x : *this)
+			{
+				c.push_back(x);
+			}
+			return c;
+		}
 	};
 
 	template <class Base> struct iterate : Base
@@ -78,7 +93,7 @@ namespace fwd
 			return this->value();
 		}
 
-		auto operator++()
+		auto& operator++()
 		{
 			this->next();
 			return *this;
@@ -298,6 +313,214 @@ namespace fwd
 		template <class N> constexpr bool any(N digit) { return Part::any(digit); }
 		template <class N> constexpr bool all(N digit) { return Part::any(digit); }
 	};
+
+	template <class Type, class Key> struct string_sorter
+	// Orders items by the strings $Key gives for them, a character at a time
+	{
+		using view = std::remove_cvref_t<std::invoke_result_t<const Key&, const Type&>>;
+		using unit = std::make_unsigned_t<typename view::value_type>;
+		using digit = std::uint64_t;
+
+		static constexpr std::ptrdiff_t small = 16; // items left to insertion sort
+		static constexpr std::size_t width = 257; // bytes and the end of a string
+
+		Key key;
+
+		digit at(const Type& x, std::size_t d) const
+		// Character $d of $x plus one, or zero when it ends before
+		{
+			const view u = key(x);
+			return d < u.size() ? 1 + static_cast<digit>(static_cast<unit>(u[d])) : 0;
+		}
+
+		bool less(const Type& x, const Type& y, std::size_t d) const
+		// Whether $x comes first given the first $d characters are equal
+		{
+			const view u = key(x), v = key(y);
+			return u.substr(std::min(d, u.size())) < v.substr(std::min(d, v.size()));
+		}
+
+		void insertion(Type* first, Type* last, std::size_t d) const
+		{
+			for (auto i = first + 1; i < last; ++i)
+			{
+				auto x = std::move(*i);
+				auto j = i;
+				for (; first < j and less(x, j[-1], d); --j)
+				{
+					*j = std::move(j[-1]);
+				}
+				*j = std::move(x);
+			}
+		}
+
+		void multikey(Type* first, Type* last, std::size_t d) const
+		// Three way partition on character $d, looping on the equal part
+		{
+			while (small < last - first)
+			{
+				const auto a = at(first[0], d);
+				const auto b = at(first[(last - first) / 2], d);
+				const auto c = at(last[-1], d);
+				const auto pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+				auto lt = first, gt = last;
+				for (auto it = first; it < gt; )
+				{
+					const auto e = at(*it, d);
+					if (e < pivot) std::iter_swap(lt++, it++);
+					else
+					if (pivot < e) std::iter_swap(it, --gt);
+					else ++ it;
+				}
+
+				multikey(first, lt, d);
+				multikey(gt, last, d);
+				if (0 == pivot)
+				{
+					return; // all ended together
+				}
+				first = lt;
+				last = gt;
+				++ d;
+			}
+			insertion(first, last, d);
+		}
+
+		void spread(Type* first, Type* last, std::size_t& d, Type* buf, std::uint16_t* cache, std::size_t* bucket) const
+		// Stable counting pass on character $d, skipping those all items share,
+		// leaving where each digit starts in $bucket
+		{
+			const auto n = static_cast<std::size_t>(last - first);
+			for (;; ++ d)
+			{
+				std::fill_n(bucket, width + 1, 0);
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					// Read each string once per pass
+					cache[i] = static_cast<std::uint16_t>(at(first[i], d));
+					++ bucket[cache[i] + 1];
+				}
+				if (bucket[cache[0] + 1] < n or 0 == cache[0])
+				{
+					break;
+				}
+			}
+			for (std::size_t k = 1; k <= width; ++k)
+			{
+				bucket[k] += bucket[k - 1];
+			}
+			std::size_t next[width];
+			std::copy_n(bucket, width, next);
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				buf[next[cache[i]]++] = std::move(first[i]);
+			}
+			std::move(buf, buf + n, first);
+		}
+
+		void radix(Type* first, Type* last, std::size_t d, Type* buf, std::uint16_t* cache) const
+		// Most significant digit first, which keeps equal items in order, looping
+		// on the largest bucket so each recursion at least halves the items
+		{
+			while (small < last - first)
+			{
+				std::size_t bucket[width + 1];
+				spread(first, last, d, buf, cache, bucket);
+
+				std::size_t top = 1;
+				for (std::size_t k = 2; k < width; ++k)
+				{
+					if (bucket[top + 1] - bucket[top] < bucket[k + 1] - bucket[k])
+					{
+						top = k;
+					}
+				}
+				for (std::size_t k = 1; k < width; ++k)
+				{
+					const auto i = bucket[k], j = bucket[k + 1];
+					if (top != k and 1 < j - i)
+					{
+						radix(first + i, first + j, d + 1, buf + i, cache + i);
+					}
+				}
+
+				const auto i = bucket[top], j = bucket[top + 1];
+				first += i;
+				last = first + (j - i);
+				buf += i;
+				cache += i;
+				++ d;
+			}
+			insertion(first, last, d);
+		}
+	};
+
+	template <class Type, class Key = std::identity> void string_sort(span<Type> s, Key key = { })
+	// Multikey quicksort that compares each character once
+	{
+		const string_sorter<Type, Key> sorter { key };
+		sorter.multikey(s.data(), s.data() + s.size(), 0);
+	}
+
+	template <class Type, class Key = std::identity> void stable_string_sort(span<Type> s, Key key = { })
+	// Radix sort from the first byte, keeping the order of equal strings
+	{
+		using sorter = string_sorter<Type, Key>;
+		if constexpr (1 == sizeof(typename sorter::unit))
+		{
+			vector<Type> buf(s.size());
+			vector<std::uint16_t> cache(s.size());
+			sorter { key }.radix(s.data(), s.data() + s.size(), 0, buf.data(), cache.data());
+		}
+		else
+		{
+			std::stable_sort(s.begin(), s.end(), [&key](const Type& x, const Type& y)
+			{
+				return sorter { key }.less(x, y, 0);
+			});
+		}
+	}
+
+	template <class Type, class Key = std::identity> void parallel_string_sort(span<Type> s, bool stable = false, Key key = { })
+	// Split on the first byte that differs then sort the large buckets in threads
+	{
+		using sorter = string_sorter<Type, Key>;
+		constexpr std::size_t grain = 1 << 14;
+		if constexpr (1 == sizeof(typename sorter::unit))
+		{
+			if (2 * grain <= s.size())
+			{
+				const sorter that { key };
+				const auto first = s.data();
+				vector<Type> buf(s.size());
+				vector<std::uint16_t> cache(s.size());
+				std::size_t d = 0, bucket[sorter::width + 1];
+				that.spread(first, first + s.size(), d, buf.data(), cache.data(), bucket);
+
+				vector<std::future<void>> jobs;
+				for (std::size_t k = 1; k < sorter::width; ++k)
+				{
+					const auto i = bucket[k], j = bucket[k + 1];
+					auto job = [&that, &buf, &cache, first, stable, i, j, d]
+					{
+						if (stable) that.radix(first + i, first + j, d + 1, buf.data() + i, cache.data() + i);
+						else that.multikey(first + i, first + j, d + 1);
+					};
+					if (grain <= j - i) jobs.emplace_back(std::async(std::launch::async, job));
+					else
+					if (1 < j - i) job();
+				}
+				for (auto& job : jobs)
+				{
+					job.wait();
+				}
+				return;
+			}
+		}
+		if (stable) stable_string_sort(s, key);
+		else string_sort(s, key);
+	}
 }
 
 #endif // file
@@ -0,0 +1,88 @@
+#ifndef lines_hpp
+#define lines_hpp "Line Lists"
+
+#include "fmt.hpp"
+
+namespace fmt
+{
+	class lines
+	// Owned strings in one buffer seen as a span of views
+	{
+		fwd::vector<char> text; // all the lines each with a null after
+		vector items; // into text
+
+		void rebase(const char* from, const char* to);
+		// Point the views at $to after the text moved from $from
+
+	public:
+
+		lines() = default;
+		lines(lines&&) = default;
+		lines& operator=(lines&&) = default;
+		lines(const lines& that);
+		lines& operator=(const lines& that);
+
+		lines(const_span t);
+		// Copy all of $t into one buffer
+
+		void push_back(view u);
+		// Copy $u and a null to the end, moving the buffer only when it fills
+
+		void reserve(size_type count, size_type bytes);
+		// Room for $count lines of $bytes in total not counting their nulls
+
+		void clear()
+		// Keep the storage for the next use
+		{
+			text.clear();
+			items.clear();
+		}
+
+		size_type size() const
+		{
+			return items.size();
+		}
+
+		bool empty() const
+		{
+			return items.empty();
+		}
+
+		auto begin() const
+		{
+			return items.cbegin();
+		}
+
+		auto end() const
+		{
+			return items.cend();
+		}
+
+		view front() const
+		{
+			return items.front();
+		}
+
+		view back() const
+		{
+			return items.back();
+		}
+
+		view operator[](size_type n) const
+		{
+			return items[n];
+		}
+
+		operator span()
+		{
+			return { items.data(), items.size() };
+		}
+
+		operator const_span() const
+		{
+			return { items.data(), items.size() };
+		}
+	};
+}
+
+#endif // file
@@ -0,0 +1,114 @@
+#ifndef lz4_hpp
+#define lz4_hpp "LZ4 Frames"
+
+#include "fwd.hpp"
+#include "ptr.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace fmt
+{
+	struct xxh32
+	// Running XXH32 digest as used by LZ4 frames
+	{
+		explicit xxh32(std::uint32_t seed = 0);
+
+		void update(const void* data, std::size_t size);
+		// Add $size bytes at $data
+
+		std::uint32_t digest() const;
+		// Value for the bytes so far
+
+		static std::uint32_t of(const void* data, std::size_t size, std::uint32_t seed = 0);
+		// One shot digest of $size bytes at $data
+
+	private:
+
+		std::uint32_t v[4];
+		std::uint64_t total = 0;
+		unsigned char mem[16];
+		std::size_t used = 0;
+	};
+
+	namespace lz4
+	{
+		std::size_t bound(std::size_t size);
+		// Worst case packed size of a block of $size bytes
+
+		std::size_t pack(const char* in, std::size_t size, char* out, std::uint32_t* table);
+		// Compress $size bytes at $in to $out using a hash $table of 4096 entries
+
+		std::ptrdiff_t unpack(const char* in, std::size_t size, char* base, std::size_t pos, std::size_t end);
+		// Expand a block at $in into $base from $pos with earlier output as history,
+		// writing no further than $end plus some slack, and return the new position
+		// or a negative value when the block is corrupt
+	}
+
+	class lz4buf : public fwd::basic_buf<char>
+	// Compress to or expand from an LZ4 frame on the $next buffer as data flows
+	{
+	public:
+
+		using base = fwd::basic_buf<char>;
+
+		explicit lz4buf(base* next, std::size_t block = 1 << 16);
+		// Layer on $next with blocks of 64K, 256K, 1M or 4M when writing
+
+		lz4buf(const lz4buf&) = delete;
+		lz4buf& operator=(const lz4buf&) = delete;
+		~lz4buf();
+
+		bool finish();
+		// Write what remains and the end of the frame, once
+
+		bool intact() const
+		// No damage or short input was seen
+		{
+			return not failed;
+		}
+
+	protected:
+
+		int_type overflow(int_type c) override;
+		int_type underflow() override;
+		int sync() override;
+
+	private:
+
+		enum class state { idle, put, get, done };
+
+		base* next;
+		std::size_t block;
+		std::vector<char> buf; // put area, or history then get area
+		std::vector<char> packed; // one block as stored
+		std::vector<std::uint32_t> table; // for matches
+		xxh32 sum;
+		state mode = state::idle;
+		bool linked = false, blocks = false, checked = false, failed = false;
+
+		bool write(const void* data, std::size_t size);
+		bool read(void* data, std::size_t size);
+		bool flush(bool last);
+		bool header();
+		bool fill();
+		bool verify(const void* data, std::size_t size);
+	};
+
+	template
+	<
+		template <class, template <class> class> class Stream
+	>
+	struct basic_lz4_stream : fwd::no_copy, Stream<char, std::char_traits>, lz4buf
+	{
+		using stream = Stream<char, std::char_traits>;
+
+		basic_lz4_stream(fwd::basic_buf<char>* next)
+		: stream(this), lz4buf(next)
+		{ }
+	};
+
+	using lz4_istream = basic_lz4_stream<fwd::basic_istream>;
+	using lz4_ostream = basic_lz4_stream<fwd::basic_ostream>;
+}
+
+#endif // file
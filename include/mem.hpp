@@ -0,0 +1,186 @@
+#ifndef mem_hpp
+#define mem_hpp "Scratch Memory"
+
+#include "fmt.hpp"
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace fmt::scratch
+{
+	class arena : fwd::no_copy
+	// Monotonic chunks for one thread, rewound when a scope closes
+	{
+		struct chunk
+		{
+			std::unique_ptr<char[]> data;
+			std::size_t size;
+		};
+
+		fwd::vector<chunk> chunks;
+		std::size_t index = 0; // current chunk
+		std::size_t used = 0; // bytes taken from it
+		int depth = 0; // open scopes
+
+		void* grow(std::size_t size, std::size_t align);
+		// Move on to the next chunk that fits
+
+	public:
+
+		using mark = fwd::pair<std::size_t>;
+
+		static arena& local()
+		{
+			static thread_local arena that;
+			return that;
+		}
+
+		bool active() const
+		{
+			return 0 < depth;
+		}
+
+		int level() const
+		// Scopes open now
+		{
+			return depth;
+		}
+
+		bool owns(const void* ptr) const;
+		// Whether $ptr lies in any chunk
+
+		void* allocate(std::size_t size, std::size_t align)
+		{
+			if (index < chunks.size())
+			{
+				const auto& top = chunks[index];
+				const auto base = reinterpret_cast<std::uintptr_t>(top.data.get());
+				const auto at = (base + used + align - 1) & ~(align - 1);
+				if (at + size <= base + top.size)
+				{
+					used = at + size - base;
+					return reinterpret_cast<void*>(at);
+				}
+			}
+			return grow(size, align);
+		}
+
+		void deallocate(void* ptr, std::size_t size)
+		{
+			// Only the last allocation can be given back
+			if (index < chunks.size())
+			{
+				const auto top = chunks[index].data.get() + used;
+				if (static_cast<char*>(ptr) + size == top)
+				{
+					used -= size;
+				}
+			}
+		}
+
+		mark enter()
+		{
+			++ depth;
+			return { index, used };
+		}
+
+		void leave(mark at)
+		{
+			#ifdef assert
+			assert(active());
+			#endif
+			-- depth;
+			index = at.first;
+			used = at.second;
+		}
+	};
+
+	struct scope : fwd::no_copy
+	// Scratch memory taken after this is released when it closes
+	{
+		arena& local;
+		arena::mark at;
+
+		scope() : local(arena::local()), at(local.enter())
+		{ }
+
+		~scope()
+		{
+			local.leave(at);
+		}
+	};
+
+	template <class Type> struct allocator
+	// Arena memory when made inside a scope, otherwise the heap, so that a
+	// container keeps to one or the other however scopes open and close
+	{
+		using value_type = Type;
+		using propagate_on_container_swap = std::true_type;
+
+		arena* from = nullptr; // or the heap
+		int depth = 0; // scopes open when made
+
+		allocator()
+		{
+			auto& local = arena::local();
+			if (local.active())
+			{
+				from = &local;
+				depth = local.level();
+			}
+		}
+
+		template <class Other> allocator(const allocator<Other>& that)
+		: from(that.from), depth(that.depth)
+		{ }
+
+		allocator select_on_container_copy_construction() const
+		// A copy takes from where it is made
+		{
+			return { };
+		}
+
+		Type* allocate(std::size_t n)
+		{
+			const auto size = n * sizeof(Type);
+			if (nullptr == from)
+			{
+				return static_cast<Type*>(::operator new(size));
+			}
+			check();
+			return static_cast<Type*>(from->allocate(size, alignof(Type)));
+		}
+
+		void deallocate(Type* ptr, std::size_t n)
+		{
+			if (nullptr == from)
+			{
+				::operator delete(ptr);
+				return;
+			}
+			check();
+			from->deallocate(ptr, n * sizeof(Type));
+		}
+
+		void check() const
+		// The scope it was made in is still open on the same thread
+		{
+			#ifdef assert
+			assert(&arena::local() == from);
+			assert(depth <= from->level());
+			#endif
+		}
+
+		template <class Other> bool operator==(const allocator<Other>& that) const
+		{
+			return from == that.from;
+		}
+	};
+
+	using string = fwd::basic_string<char, std::char_traits, allocator>;
+	using wstring = fwd::basic_string<wchar_t, std::char_traits, allocator>;
+	using vector = fmt::layout<view, allocator>::vector;
+	using wvector = fmt::layout<wide, allocator>::vector;
+}
+
+#endif // file
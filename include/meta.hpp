@@ -34,7 +34,7 @@ namespace doc
 	};
 
 	template <class Type> static sys::exclusive<store<Type>> local;
-	extern sys::exclusive<std::map<std::type_index, interface*>> registry;
+	extern sys::exclusive<fwd::hash_map<std::type_index, interface*>> registry;
 
 	// public
 
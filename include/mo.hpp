@@ -0,0 +1,42 @@
+#ifndef mo_hpp
+#define mo_hpp "Message Objects"
+
+#include "fmt.hpp"
+#include "file.hpp"
+#include <cstdint>
+#include <locale>
+
+namespace fmt
+{
+	class mo : fwd::no_copy
+	// Translations read in place from a mapped GNU .mo file
+	{
+		using word = std::uint32_t;
+
+		env::file::unique_buf buf;
+		std::size_t size = 0;
+		word count = 0, orig = 0, trans = 0, slots = 0, table = 0;
+		bool swap = false;
+
+		word at(std::size_t off) const;
+		// Word at byte offset $off in file order
+
+		view entry(word index, word n) const;
+		// Message $n of the descriptor table at $index, up to its first NUL
+
+	public:
+
+		explicit mo(view path);
+		// Map the file at $path, being false when it is absent or invalid
+
+		operator bool() const;
+
+		view find(view msgid) const;
+		// Translation of $msgid, or empty when there is none
+
+		static string path(view domain, const std::locale& loc);
+		// Location of the catalog for $domain in $loc, or empty
+	};
+}
+
+#endif // file
@@ -9,21 +9,29 @@ namespace env::opt
 	bool set(fmt::pair, fmt::view);
 	fmt::view get(fmt::view, fmt::view);
 	bool set(fmt::view, fmt::view);
+	fmt::view get(fmt::atoms, fmt::view);
+	bool set(fmt::atoms, fmt::view);
 
 	bool get(fmt::pair, bool);
 	bool set(fmt::pair, bool);
 	bool get(fmt::view, bool);
 	bool set(fmt::view, bool);
+	bool get(fmt::atoms, bool);
+	bool set(fmt::atoms, bool);
 
 	long get(fmt::pair, long, int base = 10);
 	bool set(fmt::pair, long, int base = 10);
 	long get(fmt::view, long, int base = 10);
 	bool set(fmt::view, long, int base = 10);
+	long get(fmt::atoms, long, int base = 10);
+	bool set(fmt::atoms, long, int base = 10);
 
 	float get(fmt::pair, float);
 	bool set(fmt::pair, float, int digits = 6);
 	float get(fmt::view, float);
 	bool set(fmt::view, float, int digits = 6);
+	float get(fmt::atoms, float);
+	bool set(fmt::atoms, float, int digits = 6);
 
 	fmt::output put(fmt::output);
 	// Write options to output string
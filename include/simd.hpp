@@ -0,0 +1,79 @@
+#ifndef simd_hpp
+#define simd_hpp "Vector Kernels"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fmt::simd
+{
+	using size_t = std::size_t;
+
+	struct charset
+	// Byte values as rows of bits by low nibble, split on the high bit
+	{
+		unsigned char row[2][16] = { };
+
+		constexpr void insert(unsigned char c)
+		{
+			row[c >> 7][c & 15] |= 1 << ((c >> 4) & 7);
+		}
+
+		constexpr bool contains(unsigned char c) const
+		{
+			return (row[c >> 7][c & 15] >> ((c >> 4) & 7)) & 1;
+		}
+	};
+
+	const char* isa();
+	// Name of the instruction set picked at runtime
+
+	size_t find(const char* s, size_t n, char c);
+	// Offset in $s of size $n of the first $c, or $n when absent
+
+	size_t find(const char* s, size_t n, const char* t, size_t m);
+	// Offset in $s of size $n of the first $t of size $m, or $n when absent
+
+	size_t find_of(const char* s, size_t n, const char* t, size_t m);
+	// Offset in $s of the first byte in set $t of at most 16 bytes, or $n
+
+	size_t find_not_of(const char* s, size_t n, const char* t, size_t m);
+	// Offset in $s of the first byte not in set $t of at most 16 bytes, or $n
+
+	size_t count(const char* s, size_t n, char c);
+	// Number of bytes $c in $s of size $n
+
+	size_t count(const char* s, size_t n, const char* t, size_t m);
+	// Number of non-overlapping $t of size $m in $s of size $n
+
+	size_t find_in(const char* s, size_t n, const charset& t);
+	// Offset of the first byte in $s which is in set $t, or $n
+
+	size_t find_not_in(const char* s, size_t n, const charset& t);
+	// Offset of the first byte in $s which is not in set $t, or $n
+
+	void classify(const char* s, size_t n, const charset& t, std::uint64_t* out);
+	// Set bit $i of $out when byte $i of $s is in $t, filling (n + 63) / 64 words
+
+	size_t ascii(const char* s, size_t n);
+	// Offset of the first byte in $s above 0x7F, or $n
+
+	size_t invalid(const char* s, size_t n);
+	// Offset in $s of the first ill formed UTF-8 sequence, or $n
+
+	size_t runes(const char* s, size_t n);
+	// Number of UTF-8 code points in $s, being bytes that are not continuations
+
+	size_t iequal(const char* s, const char* t, size_t n);
+	// Offset of the first byte where $s and $t of size $n differ in ASCII case folding, or $n
+
+	size_t ifind(const char* s, size_t n, const char* t, size_t m);
+	// Offset in $s of size $n of the first $t of size $m ignoring ASCII case, or $n when absent
+
+	std::uint32_t crc32c(std::uint32_t crc, const char* s, size_t n);
+	// CRC32C of $s of size $n continuing from $crc, which is zero at the start
+
+	constexpr size_t set_max = 16;
+	// Largest byte set accepted by find_of and find_not_of
+}
+
+#endif // file
@@ -0,0 +1,98 @@
+#ifndef subst_hpp
+#define subst_hpp "Substitution"
+
+#include "fmt.hpp"
+#include "simd.hpp"
+
+namespace fmt
+{
+	template <class Char> class basic_replacer
+	// Replace many needles with an Aho-Corasick automaton of the reversed needles
+	// that finds the longest needle at each start in a window scanned backwards
+	{
+	public:
+
+		using string = basic_string<Char>;
+		using view = typename string::view;
+		using pair = typename view::pair;
+		using init = fwd::init<pair>;
+		using span = fwd::span<const pair>;
+		using input = typename view::input;
+		using output = typename view::output;
+
+		basic_replacer(span t);
+		// Compile the first of each pair in $t to be replaced by the second
+
+		basic_replacer(init t)
+		: basic_replacer(span(t.begin(), t.size()))
+		{ }
+
+		string replace(view u) const;
+		// Copy of $u with the leftmost longest needles replaced
+
+		string& replace_to(string& s, view u) const;
+		// Replace into $s reusing its storage
+
+		output replace(input in, output out) const;
+		// Copy $in to $out replacing needles while holding back only a partial match
+
+		size_type count(view u) const;
+		// Number of needles that are replaced in $u
+
+		size_type size() const
+		{
+			return length.size();
+		}
+
+	private:
+
+		struct cursor
+		// Scan position in a buffer and what was written
+		{
+			size_type i = 0, done = 0, count = 0;
+			fwd::vector<int> best; // needle at each start in the window
+
+			void shift(size_type n)
+			{
+				i -= n;
+				done -= n;
+			}
+		};
+
+		int width = 1; // classes of code unit
+		int small[256] = { }; // class of each unit below 256
+		fwd::map<Char, int> large; // and the rest
+		fwd::vector<int> jump; // state by class, a row per node
+		fwd::vector<int> match; // longest needle read backwards to each node
+		fwd::vector<size_type> length; // of each needle
+		fwd::vector<size_pair> offset; // of its replacement in text
+		size_type longest = 0; // needle
+		string text; // all the replacements
+		fwd::vector<char> lead; // classes that can begin a needle
+		simd::charset first; // bytes that can begin a needle
+
+		int unit(Char c) const;
+		// Class of code unit $c where zero is in no needle
+
+		int next(int node, Char c) const
+		{
+			return jump[node * width + unit(c)];
+		}
+
+		view with(int k) const;
+		// Replacement for needle $k
+
+		size_type skip(view u) const;
+		// Offset in $u of the first unit that can begin a needle
+
+		template <class Out> size_type run(view u, cursor& at, bool last, Out out) const;
+		// Scan $u from $at passing text and replacements to $out, the end
+		// being final when $last, and return how much of $u was written;
+		// each unit is read at most twice whatever the needles
+	};
+
+	using replacer = basic_replacer<char>;
+	using wreplacer = basic_replacer<wchar_t>;
+}
+
+#endif // file
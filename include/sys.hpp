@@ -107,11 +107,21 @@ namespace sys
 	constexpr auto umask = ::_umask;
 	constexpr auto unlink = ::_unlink;
 	constexpr auto write = ::_write;
+
+	struct iovec
+	{
+		void* iov_base;
+		size_t iov_len;
+	};
+
+	ssize_t readv(int fd, const iovec* iov, int count);
+	ssize_t writev(int fd, const iovec* iov, int count);
 }
 
 #else // POSIX
 
 #include <unistd.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 
 #ifndef O_BINARY
@@ -179,6 +189,10 @@ namespace sys
 	constexpr auto umask = ::umask;
 	constexpr auto unlink = ::unlink;
 	constexpr auto write = ::write;
+
+	using iovec = ::iovec;
+	constexpr auto readv = ::readv;
+	constexpr auto writev = ::writev;
 }
 
 #endif // OS
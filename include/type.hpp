@@ -4,7 +4,12 @@
 #include "fmt.hpp"
 #include "tmp.hpp"
 #include "it.hpp"
+#include "utf.hpp"
 #include <locale>
+#include <cstdint>
+#include <mutex>
+#include <bit>
+#include <cstdio>
 
 namespace fmt
 {
@@ -14,8 +19,11 @@ namespace fmt
 		void set(std::locale&);
 	}
 
+	class mo;
+
 	using mask = std::ctype_base::mask;
 	using mark = fwd::vector<mask>;
+	using bitmap = fwd::vector<std::uint64_t>;
 
 	inline mask
 		space  = std::ctype_base::space,
@@ -50,6 +58,7 @@ namespace fmt
 		using set        = typename string::set;
 		using init       = typename view::init;
 		using span       = typename view::span;
+		using const_span = typename view::const_span;
 		using pair       = typename view::pair;
 		using vector     = typename view::vector;
 		using matrix     = typename view::matrix;
@@ -64,10 +73,14 @@ namespace fmt
 		{
 			catalog(view), ~catalog();
 			view operator()(view u, int=0, int=0);
+			// Translation of $u kept by the catalog, or a copy of $u
 			operator bool() const;
 		private:
-			std::messages_base::catalog id;
-			set cache;
+			std::messages_base::catalog id = -1;
+			std::unique_ptr<const mo> table; // mapped in place
+			std::mutex lock; // for the cache
+			set cache; // owns the text
+			fwd::hash_map<view, view> found; // translations in the cache
 		};
 
 		static bool check(Char c, mask x = space);
@@ -76,6 +89,9 @@ namespace fmt
 		static mark check(view u);
 		// Classify all characters in $u
 
+		static bitmap classify(view u, mask x);
+		// Bit $i set in word $i/64 where character $i of $u is an $x
+
 		static iterator next(iterator it, iterator end, mask x = space);
 		// Next iterator after $it but before $end which is an $x
 
@@ -91,6 +107,12 @@ namespace fmt
 		static vector split(view u, mask x = space);
 		// Split strings in $u delimited by $x
 
+		static size_type find(view u, mask x, size_type pos = 0);
+		// Position in $u from $pos of the first $x or npos
+
+		static size_type find_not(view u, mask x, size_type pos = 0);
+		// Position in $u from $pos of the first not $x or npos
+
 		static iterator first(view u, mask x = space);
 		// First iterator in view $u that is not $x
 
@@ -115,6 +137,21 @@ namespace fmt
 		static string to_lower(view u);
 		// Recode characters in lower case
 
+		static Char* to_upper(Char* begin, Char* end);
+		// Recode characters in place in upper case
+
+		static Char* to_lower(Char* begin, Char* end);
+		// Recode characters in place in lower case
+
+		static bool iequal(view u, view v);
+		// Compare $u and $v ignoring case
+
+		static bool istarts_with(view u, view v);
+		// Whether $u begins with $v ignoring case
+
+		static size_type ifind(view u, view v, size_type pos = 0);
+		// Position in $u from $pos of the first $v ignoring case or npos
+
 		static pair to_pair(view u, view v);
 		// Divide $u by first occurrence of $v
 
@@ -124,12 +161,36 @@ namespace fmt
 		static size_type count(view u, view v);
 		// Count occurrences in $u of a substring $v
 
-		static string join(span t, view u);
+		static string join(const_span t, view u);
 		// Join strings in $t with $u inserted
 
+		static size_type join_size(const_span t, view u);
+		// Length of the strings in $t joined with $u
+
+		static string& join_to(string& s, const_span t, view u);
+		// Join strings in $t with $u into $s reusing its storage unless a part is in it
+
+		template <class Out> static Out join_to(Out out, const_span t, view u)
+		// Join strings in $t with $u through the iterator $out
+		{
+			const auto begin = t.begin(), end = t.end();
+			for (auto it = begin; it != end; ++it)
+			{
+				if (begin != it)
+				{
+					out = std::copy(u.begin(), u.end(), out);
+				}
+				out = std::copy(it->begin(), it->end(), out);
+			}
+			return out;
+		}
+
 		static vector split(view u, view v);
 		// Split strings in $u delimited by $v
 
+		static size_type find(view u, view v, size_type pos = 0);
+		// Position in $u from $pos of the first $v or npos
+
 		static string replace(view u, view v, view w);
 		// Replace in $u all occurrences of $v with $w
 
@@ -226,6 +287,101 @@ namespace fmt
 			return fwd::range<iterator>(begin, end);
 		}
 
+		struct word
+		// Cursor over the runs in $u which are not $x
+		{
+			view u;
+			mask x;
+			size_type pos, end;
+
+			word(view u, mask x, size_type pos)
+			: u(u), x(x)
+			{
+				seek(pos);
+			}
+
+			bool operator!=(const word& it) const
+			{
+				return it.pos != pos;
+			}
+
+			view value() const
+			{
+				return u.substr(pos, end - pos);
+			}
+
+			void next()
+			{
+				seek(end);
+			}
+
+		private:
+
+			void seek(size_type at)
+			{
+				pos = find_not(u, x, at);
+				end = npos == pos ? npos : std::min(find(u, x, pos), u.size());
+			}
+		};
+
+		struct token
+		// Cursor over the substrings in $u between each $v
+		{
+			view u, v;
+			size_type pos, end;
+
+			token(view u, view v, size_type pos)
+			: u(u), v(v), pos(pos)
+			{
+				seek();
+			}
+
+			bool operator!=(const token& it) const
+			{
+				return it.pos != pos;
+			}
+
+			view value() const
+			{
+				return u.substr(pos, end - pos);
+			}
+
+			void next()
+			{
+				pos = end + v.size();
+				seek();
+			}
+
+		private:
+
+			void seek()
+			{
+				if (pos < u.size())
+				{
+					end = v.empty() ? u.size() : std::min(find(u, v, pos), u.size());
+				}
+				else
+				{
+					pos = end = npos;
+				}
+			}
+		};
+
+		using words = fwd::range<fwd::iterate<word>>;
+		using tokens = fwd::range<fwd::iterate<token>>;
+
+		static words tokenize(view u, mask x = space)
+		// Lazy split of $u delimited by $x
+		{
+			return words { { u, x, 0 }, { u, x, npos } };
+		}
+
+		static tokens tokenize(view u, view v)
+		// Lazy split of $u delimited by $v
+		{
+			return tokens { { u, v, 0 }, { u, v, npos } };
+		}
+
 		template <class It> static It scan_is(It begin, It end, mask x);
 		// Generic implementation of the base type's virtual method, scan_is
 
@@ -233,6 +389,57 @@ namespace fmt
 		// Generic implementation of the base type's virtual method, scan_not
 	};
 
+	inline auto ones(const bitmap& b)
+	// Positions of the set bits in $b
+	{
+		struct cursor
+		{
+			const bitmap* that;
+			size_type at;
+			std::uint64_t word;
+
+			cursor(const bitmap* b, size_type n)
+			: that(b), at(n), word(n < b->size() ? (*b)[n] : 0)
+			{
+				seek();
+			}
+
+			bool operator!=(const cursor& it) const
+			{
+				return it.at != at or it.word != word;
+			}
+
+			size_type value() const
+			{
+				return at * 64 + std::countr_zero(word);
+			}
+
+			void next()
+			{
+				word &= word - 1;
+				seek();
+			}
+
+		private:
+
+			void seek()
+			{
+				while (0 == word and at < that->size())
+				{
+					if (++ at < that->size()) word = (*that)[at];
+				}
+			}
+		};
+
+		return fwd::range<fwd::iterate<cursor>>
+		{
+			{ &b, 0 }, { &b, b.size() }
+		};
+	}
+
+	auto ones(bitmap&&) = delete;
+	// Positions must not outlive the bitmap
+
 	//
 	// Shims
 	//
@@ -242,6 +449,11 @@ namespace fmt
 		return type<char>::catalog(name);
 	}
 
+	inline auto classify(view u, mask x = space)
+	{
+		return type<char>::classify(u, x);
+	}
+
 	inline auto next(iterator it, iterator end, mask x = space)
 	{
 		return type<char>::next(it, end, x);
@@ -302,6 +514,31 @@ namespace fmt
 		return type<char>::to_lower(u);
 	}
 
+	inline auto to_upper(char* begin, char* end)
+	{
+		return type<char>::to_upper(begin, end);
+	}
+
+	inline auto to_lower(char* begin, char* end)
+	{
+		return type<char>::to_lower(begin, end);
+	}
+
+	inline auto iequal(view u, view v)
+	{
+		return type<char>::iequal(u, v);
+	}
+
+	inline auto istarts_with(view u, view v)
+	{
+		return type<char>::istarts_with(u, v);
+	}
+
+	inline auto ifind(view u, view v, size_type pos = 0)
+	{
+		return type<char>::ifind(u, v, pos);
+	}
+
 	inline bool terminated(view u)
 	{
 		return type<char>::terminated(u);
@@ -312,11 +549,26 @@ namespace fmt
 		return type<char>::count(u, v);
 	}
 
-	inline string join(span t, view u = tag::empty)
+	inline string join(const_span t, view u = tag::empty)
 	{
 		return type<char>::join(t, u);
 	}
 
+	inline auto join_size(const_span t, view u = tag::empty)
+	{
+		return type<char>::join_size(t, u);
+	}
+
+	inline string& join_to(string& s, const_span t, view u = tag::empty)
+	{
+		return type<char>::join_to(s, t, u);
+	}
+
+	template <class Out> inline Out join_to(Out out, const_span t, view u = tag::empty)
+	{
+		return type<char>::join_to(out, t, u);
+	}
+
 	inline auto split(view u, mask x = space)
 	{
 		return type<char>::split(u, x);
@@ -327,6 +579,19 @@ namespace fmt
 		return type<char>::split(u, v);
 	}
 
+	using words = type<char>::words;
+	using tokens = type<char>::tokens;
+
+	inline auto tokenize(view u, mask x = space)
+	{
+		return type<char>::tokenize(u, x);
+	}
+
+	inline auto tokenize(view u, view v)
+	{
+		return type<char>::tokenize(u, v);
+	}
+
 	inline auto replace(view u, view v, view w)
 	{
 		return type<char>::replace(u, v, w);
@@ -436,17 +701,25 @@ namespace fmt
 	template <>
 	inline string to_string(const wide& w)
 	{
-		string s;
-		for (auto c : type<wchar_t>::narrow(w)) s += c;
-		return s;
+		return utf::encode<wchar_t>(w);
 	}
 
 	template <>
 	inline wstring to_wstring(const view& s)
 	{
-		wstring w;
-		for (auto c : type<char>::widen(s)) w += c;
-		return w;
+		return utf::decode<wchar_t>(s);
+	}
+
+	template <>
+	inline string to_string(const page& p)
+	{
+		return utf::encode<char32_t>(p);
+	}
+
+	template <>
+	inline string to_string(const ustring& p)
+	{
+		return to_string(page(p));
 	}
 
 	template <>
@@ -496,6 +769,57 @@ namespace fmt
 	{
 		return to_wstring(string(1, c));
 	}
+
+	template <class Char, size_type Size = FILENAME_MAX> class basic_cstr : fwd::no_copy
+	// Null terminated form of a view for system calls, kept on the stack unless long
+	{
+		using view = typename type<Char>::view;
+		using string = typename type<Char>::string;
+
+		Char local[Size];
+		std::unique_ptr<Char[]> heap;
+		const Char* ptr;
+
+	public:
+
+		basic_cstr(const Char* s)
+		// Already terminated
+		: ptr(s)
+		{ }
+
+		basic_cstr(const string& s)
+		// Owner keeps the terminator
+		: ptr(s.c_str())
+		{ }
+
+		explicit basic_cstr(view u)
+		// Copied since a view may end anywhere
+		{
+			const auto n = u.size();
+			auto buf = local;
+			if (Size <= n)
+			{
+				heap.reset(new Char[n + 1]);
+				buf = heap.get();
+			}
+			std::copy(u.begin(), u.end(), buf);
+			buf[n] = Char();
+			ptr = buf;
+		}
+
+		const Char* data() const
+		{
+			return ptr;
+		}
+
+		operator const Char*() const
+		{
+			return ptr;
+		}
+	};
+
+	using cstr = basic_cstr<char>;
+	using wcstr = basic_cstr<wchar_t>;
 }
 
 #endif // file
@@ -0,0 +1,24 @@
+#ifndef utf_hpp
+#define utf_hpp "Unicode Transcoding"
+
+#include "fmt.hpp"
+
+namespace fmt::utf
+{
+	constexpr char32_t bad = 0xFFFD;
+	// Replacement for ill formed input
+
+	size_type check(view u);
+	// Position in $u of the first ill formed sequence or npos
+
+	size_type count(view u);
+	// Number of code points in $u
+
+	template <class Char> basic_string<Char> decode(view u, size_type* pos = nullptr);
+	// UTF-8 to UTF-16 or UTF-32 by size of $Char with first error at $pos or npos
+
+	template <class Char> string encode(fwd::basic_string_view<Char> w, size_type* pos = nullptr);
+	// UTF-16 or UTF-32 by size of $Char to UTF-8 with first error at $pos or npos
+}
+
+#endif // file
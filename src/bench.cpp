@@ -0,0 +1,386 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "fmt.hpp"
+#include "type.hpp"
+#include "subst.hpp"
+#include "dir.hpp"
+#include "lz4.hpp"
+#include "simd.hpp"
+#include "io.hpp"
+#include "sys.hpp"
+#include <chrono>
+#include <iomanip>
+
+#ifdef TEST
+
+namespace
+{
+	volatile std::size_t sink; // results are kept so the work is not elided
+
+	template <class Work> void measure(fmt::view name, std::size_t bytes, Work work)
+	// Repeat $work in doubling batches for a fixed time then print its rates
+	{
+		using clock = std::chrono::steady_clock;
+		constexpr auto budget = std::chrono::milliseconds(200);
+
+		std::size_t ops = 0;
+		const auto start = clock::now();
+		auto elapsed = clock::duration::zero();
+		for (std::size_t batch = 1; elapsed < budget; batch *= 2)
+		{
+			for (auto n = batch; 0 < n; --n)
+			{
+				sink = sink + work();
+			}
+			ops += batch;
+			elapsed = clock::now() - start;
+		}
+
+		const auto ns = std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+		const auto mbs = bytes * 1e3 / ns; // bytes per ns are GB/s
+		fmt::results()
+			<< name << fmt::tag::tab
+			<< std::fixed << std::setprecision(1)
+			<< ns << " ns/op" << fmt::tag::tab
+			<< mbs << " MB/s" << fmt::tag::eol;
+	}
+
+	struct corpus
+	// Realistic inputs for the string kernels
+	{
+		fmt::string tokens, line, utf;
+
+		corpus()
+		{
+			constexpr fmt::view words[] =
+			{
+				"alpha", "beta", "gamma", "x", "delta", "id", "epsilon", "--name"
+			};
+			for (auto n = 0; n < 64; ++n)
+			{
+				tokens += words[n % std::size(words)];
+				tokens += ' ';
+			}
+
+			while (line.size() < 4096)
+			{
+				line += "  The quick brown fox jumps over the lazy dog;";
+				line += " path/to/some/file.txt=value  ";
+			}
+
+			while (utf.size() < 4096)
+			{
+				utf += "Übergrößenträger ελληνικά кириллица 日本語のテキスト ";
+			}
+		}
+
+		static const corpus& get()
+		{
+			static const corpus that;
+			return that;
+		}
+	};
+}
+
+BENCH(split)
+{
+	const auto& in = corpus::get();
+	measure("split tokens", in.tokens.size(), [&]
+	{
+		return fmt::split(in.tokens).size();
+	});
+	measure("split line", in.line.size(), [&]
+	{
+		return fmt::split(in.line, ";").size();
+	});
+}
+
+BENCH(trim)
+{
+	const auto& in = corpus::get();
+	measure("trim line", in.line.size(), [&]
+	{
+		return fmt::trim(in.line).size();
+	});
+}
+
+BENCH(join)
+{
+	const auto& in = corpus::get();
+	const auto parts = fmt::split(in.line);
+	measure("join line", in.line.size(), [&]
+	{
+		return fmt::join(parts, " ").size();
+	});
+}
+
+BENCH(to_upper)
+{
+	const auto& in = corpus::get();
+	measure("to_upper line", in.line.size(), [&]
+	{
+		return fmt::to_upper(in.line).size();
+	});
+	measure("to_upper utf", in.utf.size(), [&]
+	{
+		return fmt::to_upper(in.utf).size();
+	});
+}
+
+BENCH(widen)
+{
+	const auto& in = corpus::get();
+	measure("widen line", in.line.size(), [&]
+	{
+		return fmt::to_wstring(in.line).size();
+	});
+	measure("widen utf", in.utf.size(), [&]
+	{
+		return fmt::to_wstring(in.utf).size();
+	});
+}
+
+BENCH(replace)
+{
+	const auto& in = corpus::get();
+	measure("replace line", in.line.size(), [&]
+	{
+		return fmt::replace(in.line, "fox", "cat").size();
+	});
+}
+
+BENCH(replacer)
+{
+	const auto& in = corpus::get();
+	const fmt::replacer r
+	{
+		{ "fox", "cat" }, { "dog", "owl" }, { "path", "root" }, { "value", "$VALUE" },
+		{ "quick", "slow" }, { "lazy", "busy" }, { "file", "dir" }, { "txt", "log" },
+	};
+	fmt::string s;
+	measure("replacer line", in.line.size(), [&]
+	{
+		return r.replace_to(s, in.line).size();
+	});
+	measure("replacer tokens", in.tokens.size(), [&]
+	{
+		return r.count(in.tokens);
+	});
+	// Every start begins a needle that only fails at its end
+	const fmt::replacer a { { "a", "1" }, { "aaaaaaaaaaaaaaab", "X" } };
+	const fmt::string many(in.line.size(), 'a');
+	measure("replacer adversarial", many.size(), [&]
+	{
+		return a.count(many);
+	});
+}
+
+BENCH(ifind)
+{
+	const auto& in = corpus::get();
+	measure("ifind line", in.line.size(), [&]
+	{
+		return fmt::ifind(in.line, "FILE.TXT=VALUE;");
+	});
+	measure("iequal line", in.line.size(), [&]
+	{
+		return std::size_t(fmt::iequal(in.line, in.line));
+	});
+}
+
+BENCH(hash)
+{
+	const auto& in = corpus::get();
+	const auto parts = fmt::split(in.line);
+	fmt::view::map tree;
+	fmt::view::hash_map flat;
+	for (const auto u : parts)
+	{
+		tree[u] = u;
+		flat[u] = u;
+	}
+	const fmt::view::flat_map sorted(tree.begin(), tree.end());
+	const auto bytes = in.line.size();
+	measure("map find", bytes, [&]
+	{
+		std::size_t n = 0;
+		for (const auto u : parts)
+		{
+			n += tree.find(u)->second.size();
+		}
+		return n;
+	});
+	measure("hash_map find", bytes, [&]
+	{
+		std::size_t n = 0;
+		for (const auto u : parts)
+		{
+			n += flat.find(u)->second.size();
+		}
+		return n;
+	});
+	measure("flat_map find", bytes, [&]
+	{
+		std::size_t n = 0;
+		for (const auto u : parts)
+		{
+			n += sorted.find(u)->second.size();
+		}
+		return n;
+	});
+}
+
+BENCH(sort)
+{
+	// Paths share long prefixes which std::sort compares again each time
+	fmt::string::vector text;
+	for (int n = 0; n < 20000; ++n)
+	{
+		text.emplace_back(fmt::dir::join({ "/usr/share", fmt::to_string(n % 97), "doc", fmt::to_string(n * 7919 % 20000) }));
+	}
+	const fmt::vector paths(text.begin(), text.end());
+	std::size_t bytes = 0;
+	for (const auto u : paths)
+	{
+		bytes += u.size();
+	}
+	fmt::vector t;
+	measure("std::sort paths", bytes, [&]
+	{
+		t = paths;
+		std::sort(t.begin(), t.end());
+		return t.front().size();
+	});
+	measure("string_sort paths", bytes, [&]
+	{
+		t = paths;
+		fwd::string_sort(fmt::span(t));
+		return t.front().size();
+	});
+	measure("stable_string_sort paths", bytes, [&]
+	{
+		t = paths;
+		fwd::stable_string_sort(fmt::span(t));
+		return t.front().size();
+	});
+}
+
+BENCH(lz4)
+{
+	const auto& in = corpus::get();
+	std::string text;
+	while (text.size() < (1 << 16))
+	{
+		text += in.line;
+		text += in.tokens;
+	}
+	const auto bytes = text.size();
+	fwd::vector<char> packed(fmt::lz4::bound(bytes)), back(bytes + 64);
+	fwd::vector<std::uint32_t> table(1 << 12);
+	std::size_t size = 0;
+	measure("lz4 pack", bytes, [&]
+	{
+		size = fmt::lz4::pack(text.data(), bytes, packed.data(), table.data());
+		return size;
+	});
+	measure("lz4 unpack", bytes, [&]
+	{
+		return fmt::lz4::unpack(packed.data(), size, back.data(), 0, bytes);
+	});
+}
+
+BENCH(crc32c)
+{
+	const auto& in = corpus::get();
+	const auto bytes = in.line.size();
+	measure("crc32c", bytes, [&]
+	{
+		return fmt::simd::crc32c(0, in.line.data(), bytes);
+	});
+}
+
+BENCH(fdbuf)
+{
+	const auto& in = corpus::get();
+	const auto parts = fmt::split(in.line);
+	std::size_t bytes = 0;
+	for (const auto u : parts)
+	{
+		bytes += u.size();
+	}
+
+	env::file::shared_ptr f = env::file::temp();
+	const auto file = f.get();
+	const int fd = sys::fileno(file);
+
+	// Many small writes, through stdio or straight to the descriptor
+	measure("fwrite words", bytes, [&]
+	{
+		std::rewind(file);
+		for (const auto u : parts)
+		{
+			(void) std::fwrite(u.data(), sizeof(char), u.size(), file);
+		}
+		return std::fflush(file);
+	});
+	measure("fmt::ostream words", bytes, [&]
+	{
+		(void) sys::lseek(fd, 0, SEEK_SET);
+		fmt::ostream out(fd);
+		for (const auto u : parts)
+		{
+			(void) out.write(u.data(), u.size());
+		}
+		return out.flush() ? 0 : 1;
+	});
+
+	// Blocks of a line read back from a file of 16 lines
+	constexpr int lines = 16;
+	(void) sys::lseek(fd, 0, SEEK_SET);
+	for (int n = 0; n < lines; ++n)
+	{
+		(void) sys::write(fd, in.line.data(), static_cast<sys::size_t>(in.line.size()));
+	}
+	fmt::string buf(in.line.size(), '\0');
+	measure("fread line", lines * buf.size(), [&]
+	{
+		std::rewind(file);
+		std::size_t n = 0;
+		while (0 < std::fread(buf.data(), sizeof(char), buf.size(), file))
+		{
+			n += buf.front();
+		}
+		return n;
+	});
+	measure("fmt::istream line", lines * buf.size(), [&]
+	{
+		(void) sys::lseek(fd, 0, SEEK_SET);
+		fmt::istream is(fd);
+		std::size_t n = 0;
+		while (is.read(buf.data(), buf.size()))
+		{
+			n += buf.front();
+		}
+		return n;
+	});
+}
+
+BENCH(emplace)
+{
+	const auto& in = corpus::get();
+	const auto parts = fmt::split(in.tokens);
+	const auto bytes = in.tokens.size();
+	measure("tag::emplace tokens", bytes, [&]
+	{
+		std::size_t n = 0;
+		for (const auto u : parts)
+		{
+			n += fmt::tag::emplace(u).size();
+		}
+		return n;
+	});
+}
+
+#endif
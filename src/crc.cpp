@@ -0,0 +1,211 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "crc.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace fmt
+{
+	crcbuf::crcbuf(base* next, std::size_t size)
+	: next(next), size(std::max<std::size_t>(size, 1))
+	{ }
+
+	crcbuf::~crcbuf()
+	{
+		(void) flush();
+	}
+
+	std::uint32_t crcbuf::digest()
+	{
+		(void) flush();
+		consume();
+		return crc;
+	}
+
+	void crcbuf::consume()
+	// Sum what was read from the get area since last time
+	{
+		if (summed < gptr())
+		{
+			crc = simd::crc32c(crc, summed, static_cast<std::size_t>(gptr() - summed));
+			summed = gptr();
+		}
+	}
+
+	std::streamsize crcbuf::pass(const char* s, std::streamsize n)
+	// Write straight through, summing what was taken
+	{
+		const auto m = next->sputn(s, n);
+		crc = simd::crc32c(crc, s, static_cast<std::size_t>(std::max<std::streamsize>(m, 0)));
+		return m;
+	}
+
+	std::streamsize crcbuf::take(char* s, std::streamsize n)
+	// Read straight through, summing what was given
+	{
+		const auto m = next->sgetn(s, n);
+		crc = simd::crc32c(crc, s, static_cast<std::size_t>(std::max<std::streamsize>(m, 0)));
+		return m;
+	}
+
+	bool crcbuf::flush()
+	{
+		const auto n = pptr() - pbase();
+		if (0 < n)
+		{
+			const auto m = pass(pbase(), n);
+			if (m != n)
+			{
+				return false;
+			}
+			setp(buf.data(), buf.data() + size);
+		}
+		return true;
+	}
+
+	crcbuf::int_type crcbuf::overflow(int_type c)
+	{
+		constexpr auto eof = traits_type::eof();
+		if (nullptr == pbase())
+		{
+			buf.resize(size);
+			setp(buf.data(), buf.data() + size);
+		}
+		else
+		if (pptr() == epptr() and not flush())
+		{
+			return eof;
+		}
+		if (not traits_type::eq_int_type(eof, c))
+		{
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+	int crcbuf::sync()
+	{
+		return flush() and -1 != next->pubsync() ? 0 : -1;
+	}
+
+	std::streamsize crcbuf::xsputn(const char_type* s, std::streamsize n)
+	{
+		// Large writes skip the copy into the buffer
+		if (static_cast<std::size_t>(n) < size)
+		{
+			return base::xsputn(s, n);
+		}
+		return flush() ? pass(s, n) : 0;
+	}
+
+	crcbuf::int_type crcbuf::underflow()
+	{
+		if (gptr() == egptr())
+		{
+			// Read ahead is summed only once it is taken
+			consume();
+			buf.resize(size);
+			const auto n = next->sgetn(buf.data(), static_cast<std::streamsize>(size));
+			if (n <= 0)
+			{
+				setg(nullptr, nullptr, nullptr);
+				summed = nullptr;
+				return traits_type::eof();
+			}
+			setg(buf.data(), buf.data(), buf.data() + n);
+			summed = buf.data();
+		}
+		return traits_type::to_int_type(*gptr());
+	}
+
+	std::streamsize crcbuf::xsgetn(char_type* s, std::streamsize n)
+	{
+		// What is buffered first, then large reads skip the buffer
+		const auto k = std::min<std::streamsize>(n, egptr() - gptr());
+		if (0 < k)
+		{
+			std::memcpy(s, gptr(), static_cast<std::size_t>(k));
+			gbump(static_cast<int>(k));
+			consume();
+		}
+		if (k == n)
+		{
+			return n;
+		}
+		if (static_cast<std::size_t>(n - k) < size)
+		{
+			return k + base::xsgetn(s + k, n - k);
+		}
+		return k + std::max<std::streamsize>(take(s + k, n - k), 0);
+	}
+}
+
+#ifdef TEST
+#include <sstream>
+TEST(crc)
+{
+	std::string text;
+	for (int n = 0; text.size() < 200000; ++n)
+	{
+		text += "config-key-";
+		text += std::to_string(n);
+		text += n % 3 ? " = value\n" : " = a longer value with more in it\n";
+	}
+	const auto expect = fmt::simd::crc32c(0, text.data(), text.size());
+
+	// Small and large writes sum the same
+	std::stringbuf file;
+	{
+		fmt::crc_ostream out(&file);
+		for (std::size_t n = 0; n < 1000; ++n)
+		{
+			out.put(text[n]);
+		}
+		out.write(text.data() + 1000, 100);
+		out.write(text.data() + 1100, text.size() - 1100);
+		ASSERT(out.verify(expect));
+	}
+	ASSERT(file.str() == text);
+
+	// Reading sums what comes through
+	{
+		std::stringbuf in(text);
+		fmt::crc_istream z(&in);
+		std::string line, back;
+		while (std::getline(z, line))
+		{
+			back += line;
+			back += '\n';
+		}
+		ASSERT(back == text);
+		ASSERT(z.verify(expect));
+	}
+	{
+		std::stringbuf in(text);
+		fmt::crc_istream z(&in);
+		std::string back(text.size(), '\0');
+		(void) z.read(back.data(), 10);
+		(void) z.read(back.data() + 10, back.size() - 10);
+		ASSERT(back == text);
+		ASSERT(z.verify(expect));
+		ASSERT(not z.verify(expect ^ 1));
+	}
+
+	// Only what was taken counts, not the read ahead
+	{
+		std::stringbuf in(text);
+		fmt::crc_istream z(&in);
+		std::string line;
+		(void) std::getline(z, line);
+		const auto n = line.size() + 1;
+		ASSERT(z.verify(fmt::simd::crc32c(0, text.data(), n)));
+		char c = 0;
+		(void) z.get(c);
+		ASSERT(z.verify(fmt::simd::crc32c(0, text.data(), n + 1)));
+	}
+}
+#endif
@@ -3,7 +3,8 @@
 
 #include "err.hpp"
 #include "dig.hpp"
-#include <iomanip>
+#include "build.hpp"
+#include "format.hpp"
 #include <charconv>
 
 namespace
@@ -84,9 +85,9 @@ namespace
 		s.shrink_to_fit();
 		return s;
 		/*/
-		std::stringstream ss;
-		ss << std::fixed << std::setprecision(precision) << value;
-		return ss.str();
+		fmt::builder buf;
+		buf.append(value, precision);
+		return buf.get();
 		//*/
 	}
 }
@@ -184,4 +185,47 @@ TEST(dig)
 	EXCEPT(-1 == (signed) fmt::to_unsigned(-1));
 	EXCEPT(0L == fmt::to_long("$"));
 }
+
+TEST(build)
+{
+	ASSERT("2.50" == fmt::to_string(2.5, 2));
+	ASSERT("-0.125" == fmt::to_string(-0.125f, 3));
+
+	fmt::builder buf;
+	buf << "x=" << 42 << ' ' << -7L << ' ' << 0.5;
+	ASSERT(buf.get() == "x=42 -7 0.5");
+	buf.clear();
+	// Floats, characters and truth values as a stream has them
+	buf << 1e-9 << ' ' << 1e20 << ' ' << true << static_cast<unsigned char>('u') << static_cast<signed char>('s');
+	ASSERT(buf.get() == "1e-09 1e+20 1us");
+	buf.clear();
+	buf << 0.1 + 0.2 << ' ' << 3.14159265 << ' ' << 1234567.0f;
+	ASSERT(buf.get() == "0.3 3.14159 1.23457e+06");
+	buf.clear();
+	buf.append(255, 16);
+	ASSERT(buf.get() == "ff");
+	// Spill to the heap
+	fmt::string s;
+	for (int n = 0; n < 1000; ++n)
+	{
+		buf << n;
+		s += std::to_string(n);
+	}
+	ASSERT(buf.get() == "ff" + s);
+}
+
+TEST(format)
+{
+	ASSERT("a-1-b" == fmt::format<"{}-{}-{}">("a", 1, "b"));
+	ASSERT("{x}" == fmt::format<"{{{}}}">('x'));
+	ASSERT("ff 377 101" == fmt::format<"{:x} {:o} {:b}">(255, 255, 5));
+	ASSERT("0.50" == fmt::format<"{:.2}">(0.5));
+	ASSERT("1 c" == fmt::format<"{} {}">(true, static_cast<unsigned char>('c')));
+	ASSERT("plain" == fmt::format<"plain">());
+
+	std::tm tm { };
+	tm.tm_year = 100;
+	tm.tm_mday = 1;
+	ASSERT("2000-01-01" == fmt::format<"{:%Y-%m-%d}">(tm));
+}
 #endif
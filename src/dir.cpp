@@ -10,6 +10,7 @@
 #include "sys.hpp"
 #include "dig.hpp"
 #include "sync.hpp"
+#include "mem.hpp"
 #include <regex>
 #include <stack>
 
@@ -27,14 +28,29 @@ namespace fmt::path
 		return fmt::split(u, sys::tag::path);
 	}
 
-	string join(span p)
+	tokens tokenize(view u)
+	{
+		return fmt::tokenize(u, sys::tag::path);
+	}
+
+	string join(const_span p)
 	{
 		return fmt::join(p, sys::tag::path);
 	}
 
 	string join(init n)
 	{
-		return fmt::join(fwd::to_span(n));
+		return fmt::path::join(fwd::to_span(n));
+	}
+
+	string& join_to(string& s, const_span p)
+	{
+		return fmt::join_to(s, p, sys::tag::path);
+	}
+
+	string& join_to(string& s, init n)
+	{
+		return fmt::path::join_to(s, fwd::to_span(n));
 	}
 }
 
@@ -45,14 +61,29 @@ namespace fmt::dir
 		return fmt::split(u, sys::tag::dir);
 	}
 
-	string join(span p)
+	tokens tokenize(view u)
+	{
+		return fmt::tokenize(u, sys::tag::dir);
+	}
+
+	string join(const_span p)
 	{
 		return fmt::join(p, sys::tag::dir);
 	}
 
 	string join(init n)
 	{
-		return fmt::join(fwd::to_span(n));
+		return fmt::dir::join(fwd::to_span(n));
+	}
+
+	string& join_to(string& s, const_span p)
+	{
+		return fmt::join_to(s, p, sys::tag::dir);
+	}
+
+	string& join_to(string& s, init n)
+	{
+		return fmt::dir::join_to(s, fwd::to_span(n));
 	}
 }
 
@@ -63,20 +94,35 @@ namespace fmt::file
 		return fmt::split(u, tag::dot);
 	}
 
-	string join(span p)
+	tokens tokenize(view u)
+	{
+		return fmt::tokenize(u, tag::dot);
+	}
+
+	string join(const_span p)
 	{
 		return fmt::join(p, tag::dot);
 	}
 
 	string join(init n)
 	{
-		return fmt::join(fwd::to_span(n));
+		return fmt::file::join(fwd::to_span(n));
+	}
+
+	string& join_to(string& s, const_span p)
+	{
+		return fmt::join_to(s, p, tag::dot);
+	}
+
+	string& join_to(string& s, init n)
+	{
+		return fmt::file::join_to(s, fwd::to_span(n));
 	}
 
 	string join(div p)
 	{
 		auto part = fmt::span(p.second);
-		auto last = fmt::path::join(part);
+		auto last = fmt::file::join(part);
 		p.first.emplace_back(last);
 		part = fmt::span(p.first);
 		return fmt::dir::join(part);
@@ -111,12 +157,8 @@ namespace env::file
 
 	bool find(view path, entry check)
 	{
-		if (not fmt::terminated(path))
-		{
-			const auto buf = fmt::to_string(path);
-			return find(view(buf), check);
-		}
-		return fwd::any_of(sys::files(path.data()), check);
+		const fmt::cstr c(path);
+		return fwd::any_of(sys::files(c.data()), check);
 	}
 
 	bool find(span paths, entry check)
@@ -376,26 +418,47 @@ namespace env::file
 
 	string search(view name, entry check, order roots)
 	{
-		auto dirs = fmt::dir::split(name);
-		auto first = not fwd::equal_to(fmt::tag::dots);
-		auto it = fwd::find_if(dirs, first);
-		auto diff = std::distance(dirs.begin(), it);
-		auto sub =  fmt::span(dirs.data() + diff, dirs.size() - diff);
+		// Leading parent folders climb out of each root
+		ptrdiff_t diff = 0;
+		auto sub = name.substr(name.size());
+		for (auto u : fmt::dir::tokenize(name))
+		{
+			if (u != fmt::tag::dots)
+			{
+				sub = name.substr(u.data() - name.data());
+				break;
+			}
+			++ diff;
+		}
 		// Search predicate
 		string buf;
 		entry visit = [&](view root)
 		{
-			auto folders = fmt::dir::split(root);
-			if (ptrdiff_t size = folders.size(); size > diff)
-			 {
+			ptrdiff_t size = 0;
+			for ([[maybe_unused]] auto u : fmt::dir::tokenize(root))
+			{
+				++ size;
+			}
+			if (size > diff)
+			{
 				// Compound path parts
-				folders.resize(size - diff);
-				auto put = std::back_inserter(folders);
-				fwd::copy(sub, put);
-				// Compose a full string
-				buf = fmt::dir::join(folders);
+				auto end = root.size();
+				for (auto u : fmt::dir::tokenize(root))
+				{
+					if (1 == size -- - diff)
+					{
+						end = u.data() + u.size() - root.data();
+						break;
+					}
+				}
+				buf = root.substr(0, end);
+				if (not sub.empty())
+				{
+					buf += sys::tag::dir;
+					buf += sub;
+				}
 				return check(buf);
-			 }
+			}
 			return false;
 		};
 		// Clear if not found
@@ -408,29 +471,31 @@ namespace env::file
 
 	view mkdir(view path)
 	{
-		std::stack<view> stack;
-		string buf;
+		fmt::scratch::scope scope;
+		fmt::scratch::string buf;
 
-		auto folders = fmt::dir::split(path);
+		// Climb up to the first extant folder
 		auto stem = path;
-
-		while (env::file::fail(stem))
+		while (not stem.empty() and env::file::fail(stem))
 		{
-			stack.push(folders.back());
-			folders.pop_back();
-
-			buf = fmt::dir::join(folders);
-			stem = buf;
+			const auto pos = stem.rfind(sys::tag::dir);
+			stem = stem.substr(0, npos == pos ? 0 : pos);
 		}
 
-		stem = path.substr(0, path.find(sys::tag::dir, stem.size() + 1));
+		const auto root = stem.size();
+		stem = path.substr(0, path.find(sys::tag::dir, root + 1));
 
-		while (not stack.empty())
+		// Make each missing folder on the way down
+		for (auto pos = root; pos < path.size(); )
 		{
-			folders.push_back(stack.top());
-			stack.pop();
+			pos = path.find(sys::tag::dir, pos + 1);
+			const auto part = path.substr(0, pos);
+			buf.assign(part.data(), part.size());
+			if (buf.ends_with(sys::tag::dir))
+			{
+				continue; // empty part
+			}
 
-			buf = fmt::dir::join(folders);
 			auto const c = buf.data();
 			if (sys::fail(sys::mkdir(c, S_IRWXU)))
 			{
@@ -448,11 +513,14 @@ namespace env::file
 		std::deque<string> deque;
 		deque.emplace_back(dir);
 
-		for (auto it = deque.begin(); it != deque.end(); ++it)
+		string path;
+		// Growing the deque invalidates iterators but not references
+		for (std::size_t n = 0; n < deque.size(); ++n)
 		{
-			(void) find(*it, [&](view u)
+			const auto& folder = deque[n];
+			(void) find(folder, [&](view u)
 			{
-				auto const path = fmt::dir::join({*it, u});
+				fmt::dir::join_to(path, {folder, u});
 				auto const c = path.data();
 				struct sys::stats st(c);
 				if (sys::fail(st.ok))
@@ -464,7 +532,7 @@ namespace env::file
 				{
 					if (u != "." and u != "..")
 					{
-						deque.emplace_back(std::move(path));
+						deque.emplace_back(path);
 					}
 				}
 				else
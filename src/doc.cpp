@@ -11,7 +11,7 @@ namespace doc
 {
 	template struct instance<fwd::event>;
 
-	sys::exclusive<std::map<std::type_index, interface*>> registry;
+	sys::exclusive<fwd::hash_map<std::type_index, interface*>> registry;
 
 	interface* find(std::type_index index)
 	{
@@ -113,21 +113,44 @@ namespace doc
 
 	bool ini::put(fmt::pair key, fmt::view value)
 	{
-		auto it = keys.find(key);
-		if (keys.end() == it)
-		{
-			auto pos = keys.emplace(key, value);
-			#ifdef assert
-			assert(pos.second);
-			#endif
-			it = pos.first;
-			return pos.second;
-		}
-		else
+		const auto group = fmt::tag::intern(key.first);
+		const auto name = fmt::tag::intern(key.second);
+		return put({ group, name }, value);
+	}
+
+	bool ini::got(fmt::atoms key) const
+	{
+		return index.find(key) != index.end();
+	}
+
+	fmt::view ini::get(fmt::atoms key) const
+	{
+		const auto it = index.find(key);
+		return index.end() == it
+			? fmt::tag::empty : *it->second;
+	}
+
+	bool ini::set(fmt::atoms key, fmt::view value)
+	{
+		const auto pos = cache.emplace(value);
+		return put(key, *pos.first) and pos.second;
+	}
+
+	bool ini::put(fmt::atoms key, fmt::view value)
+	{
+		if (auto it = index.find(key); index.end() != it)
 		{
-			it->second = value;
+			*it->second = value;
 			return false;
 		}
+		// Interned text outlives the caller's buffer
+		auto& slot = keys[{ key.first.str(), key.second.str() }];
+		slot = value;
+		const auto pos = index.emplace(key, &slot);
+		#ifdef assert
+		assert(pos.second);
+		#endif
+		return pos.second;
 	}
 }
 
@@ -243,6 +266,25 @@ TEST(ini)
 			ASSERT(u == value);
 			ASSERT(u.data() == value);
 		}
+		// Same entry by interned keys
+		{
+			const fmt::atoms id { fmt::tag::intern(group), fmt::tag::intern(key) };
+			ASSERT(init.got(id));
+			ASSERT(init.get(id).data() == value);
+			ASSERT(not init.put(id, group));
+			ASSERT(init.get({group, key}) == group);
+		}
+		// Moving takes the keys along with the index into them
+		{
+			static_assert(not std::is_copy_constructible_v<doc::ini>);
+			const fmt::atoms id { fmt::tag::intern(group), fmt::tag::intern(key) };
+			doc::ini moved(std::move(init));
+			ASSERT(moved.get(id) == group);
+			ASSERT(init.keys.empty() and init.index.empty());
+			init = std::move(moved);
+			ASSERT(init.get(id) == group);
+			ASSERT(moved.keys.empty() and moved.index.empty());
+		}
 	}
 }
 
@@ -0,0 +1,230 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "edit.hpp"
+#include <algorithm>
+
+namespace fmt
+{
+	template <class C> basic_piece_table<C>::basic_piece_table(view u)
+	: base(u)
+	{
+		if (not u.empty())
+		{
+			root = make(false, 0, u.size(), seed);
+		}
+	}
+
+	template <class C> size_type basic_piece_table<C>::size() const
+	{
+		return total(root);
+	}
+
+	template <class C> void basic_piece_table<C>::insert(size_type pos, view w)
+	{
+		#ifdef assert
+		assert(pos <= size());
+		#endif
+		if (w.empty())
+		{
+			return;
+		}
+		// New text only ever appends to the added buffer
+		seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+		const auto n = make(true, added.size(), w.size(), seed);
+		added.append(w.data(), w.size());
+
+		int l, r;
+		split(root, pos, l, r);
+		root = merge(merge(l, n), r);
+	}
+
+	template <class C> void basic_piece_table<C>::erase(size_type pos, size_type n)
+	{
+		#ifdef assert
+		assert(pos <= size());
+		#endif
+		int l, m, r;
+		split(root, pos, l, r);
+		split(r, n, m, r);
+		root = merge(l, r);
+		drop(m);
+	}
+
+	template <class C> void basic_piece_table<C>::replace(size_type pos, size_type n, view w)
+	{
+		erase(pos, n);
+		insert(pos, w);
+	}
+
+	template <class C> typename basic_piece_table<C>::string basic_piece_table<C>::str() const
+	{
+		string s;
+		s.reserve(size());
+		for (const auto u : *this)
+		{
+			s.append(u.data(), u.size());
+		}
+		return s;
+	}
+
+	template <class C> typename basic_piece_table<C>::view basic_piece_table<C>::piece(int n) const
+	{
+		const auto& x = nodes[n];
+		const auto u = x.added ? view(added) : base;
+		return u.substr(x.pos, x.size);
+	}
+
+	template <class C> size_type basic_piece_table<C>::total(int n) const
+	{
+		return n < 0 ? 0 : nodes[n].total;
+	}
+
+	template <class C> void basic_piece_table<C>::update(int n)
+	{
+		auto& x = nodes[n];
+		x.total = total(x.left) + x.size + total(x.right);
+	}
+
+	template <class C> int basic_piece_table<C>::make(bool add, size_type pos, size_type size, unsigned rank)
+	{
+		const node x { pos, size, size, add, rank, -1, -1 };
+		if (free.empty())
+		{
+			nodes.push_back(x);
+			return static_cast<int>(nodes.size() - 1);
+		}
+		const auto n = free.back();
+		free.pop_back();
+		nodes[n] = x;
+		return n;
+	}
+
+	template <class C> void basic_piece_table<C>::split(int t, size_type k, int& l, int& r)
+	// Divide the tree at $t into the first $k code units at $l and the rest at $r
+	{
+		if (t < 0)
+		{
+			l = r = -1;
+			return;
+		}
+
+		const auto before = total(nodes[t].left);
+		const auto after = before + nodes[t].size;
+		if (k <= before)
+		{
+			int left;
+			split(nodes[t].left, k, l, left);
+			nodes[t].left = left;
+			r = t;
+		}
+		else
+		if (after <= k)
+		{
+			int right;
+			split(nodes[t].right, k - after, right, r);
+			nodes[t].right = right;
+			l = t;
+		}
+		else
+		{
+			// Cut the piece in two keeping the rank for heap order
+			const auto cut = k - before;
+			const auto& x = nodes[t];
+			const auto n = make(x.added, x.pos + cut, x.size - cut, x.rank);
+			nodes[n].right = nodes[t].right;
+			nodes[t].right = -1;
+			nodes[t].size = cut;
+			update(n);
+			l = t;
+			r = n;
+		}
+		update(t);
+	}
+
+	template <class C> int basic_piece_table<C>::merge(int l, int r)
+	// Join trees where all of $l comes before all of $r
+	{
+		if (l < 0) return r;
+		if (r < 0) return l;
+
+		if (nodes[r].rank < nodes[l].rank)
+		{
+			const auto right = merge(nodes[l].right, r);
+			nodes[l].right = right;
+			update(l);
+			return l;
+		}
+		else
+		{
+			const auto left = merge(l, nodes[r].left);
+			nodes[r].left = left;
+			update(r);
+			return r;
+		}
+	}
+
+	template <class C> void basic_piece_table<C>::drop(int t)
+	// Recycle every node in the tree at $t
+	{
+		if (0 <= t)
+		{
+			drop(nodes[t].left);
+			drop(nodes[t].right);
+			free.push_back(t);
+		}
+	}
+
+	template struct basic_piece_table<char>;
+	template struct basic_piece_table<wchar_t>;
+}
+
+#ifdef TEST
+#include <sstream>
+TEST(edit)
+{
+	const fmt::view Text = "the quick brown fox jumps over the lazy dog";
+
+	// Edits match the same edits on a string
+	{
+		fmt::piece_table p(Text);
+		fmt::string s(Text);
+		ASSERT(p.str() == s);
+
+		p.replace(4, 5, "slow");
+		s.replace(4, 5, "slow");
+		p.insert(0, ">> ");
+		s.insert(0, ">> ");
+		p.insert(p.size(), ".");
+		s.insert(s.size(), ".");
+		p.erase(10, 6);
+		s.erase(10, 6);
+		p.erase(p.size() - 4);
+		s.erase(s.size() - 4);
+		ASSERT(p.size() == s.size());
+		ASSERT(p.str() == s);
+
+		std::stringstream ss;
+		ss << p;
+		ASSERT(ss.str() == s);
+	}
+
+	// Pseudo random edits
+	{
+		fmt::piece_table p(Text);
+		fmt::string s(Text);
+		unsigned seed = 1;
+		for (int n = 0; n < 500; ++n)
+		{
+			seed = seed * 1103515245 + 12345;
+			const auto pos = (seed >> 8) % (s.size() + 1);
+			const auto len = (seed >> 4) % 7;
+			const fmt::view w = "xyz" + (seed >> 16) % 4;
+			p.replace(pos, len, w);
+			s.replace(pos, len, w);
+		}
+		ASSERT(p.str() == s);
+	}
+}
+#endif
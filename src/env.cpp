@@ -19,25 +19,15 @@ namespace env
 
 	bool got(fmt::view u)
 	{
-		if (not fmt::terminated(u))
-		{
-			const auto s = fmt::to_string(u);
-			return env::got(s);
-		}
-		const auto c = u.data();
+		const fmt::cstr c(u);
 		const auto unlock = lock.reader();
 		const auto ptr = std::getenv(c);
-		return nullptr == ptr;
+		return nullptr != ptr;
 	}
 
 	fmt::view get(fmt::view u)
 	{
-		if (not fmt::terminated(u))
-		{
-			const auto s = fmt::to_string(u);
-			return env::get(s);
-		}
-		const auto c = u.data();
+		const fmt::cstr c(u);
 		const auto unlock = lock.reader();
 		const auto ptr = std::getenv(c);
 		return nullptr == ptr ? "" : ptr;
@@ -72,23 +62,23 @@ namespace env
 		return env::put(s);
 	}
 
-	fmt::span vars()
+	const fmt::lines& vars()
 	{
-		static thread_local fmt::vector local;
+		// Copied since a later put may change the environment
+		static thread_local fmt::lines local;
 		local.clear();
 		for (auto c = sys::environment(); *c; ++c)
 		{
-			local.emplace_back(*c);
+			local.push_back(*c);
 		}
 		return local;
 	}
 
-	fmt::span path()
+	const fmt::lines& path()
 	{
-		static thread_local fmt::vector t;
+		static thread_local fmt::lines t;
 		auto u = env::get("PATH");
-		t = fmt::path::split(u);
-		return t;
+		return fmt::path::tokenize(u).to(t);
 	}
 
 	fmt::view temp()
@@ -260,8 +250,9 @@ namespace env
 
 	fmt::view echo(fmt::view u)
 	{
+		// Interned since callers keep what was echoed before
 		const auto p = env::exe::echo(u);
-		return p.empty() ? "" : p.front();
+		return p.empty() ? fmt::tag::empty : fmt::tag::emplace(p.front());
 	}
 
 	fmt::view text(fmt::view u)
@@ -276,5 +267,8 @@ TEST(path)
 {
 	ASSERT(env::get("PATH") == fmt::path::join(env::path()));
 	ASSERT(env::get("PATH") == env::echo("PATH"));
+	const auto home = env::echo("HOME");
+	(void) env::echo("PATH");
+	ASSERT(home == env::get("HOME"));
 }
 #endif
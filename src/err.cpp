@@ -25,13 +25,18 @@ namespace fmt
 		true;
 	#endif
 
-	thread_local buffer local_buf;
+	thread_local buffer local_buf, local_results;
 
 	std::ostream& out()
 	{
 		return local_buf;
 	}
 
+	std::ostream& results()
+	{
+		return local_results;
+	}
+
 	std::ostream& put(std::ostream& buf)
 	{
 		string line;
@@ -45,12 +50,14 @@ namespace fmt
 
 namespace
 {
-	void runner(fmt::view name, fmt::string::buf::ptr buf, bool host)
+	void runner(fmt::view name, fmt::string::buf::ptr buf, fmt::string::buf::ptr result, bool host)
 	{
 		auto back = fmt::out().rdbuf();
+		auto last = fmt::results().rdbuf();
 		try
 		{
 			fmt::out().rdbuf(buf);
+			fmt::results().rdbuf(result);
 			if (host)
 			{
 				auto call = sys::sym<void()>(name);
@@ -69,7 +76,15 @@ namespace
 				fmt::vector args { image, "-o", "-q", name };
 				for (auto line : env::exe::get(args))
 				{
-					fmt::out() << line << fmt::tag:: eol;
+					// Results come back indented
+					if (line.starts_with(fmt::tag::tab))
+					{
+						fmt::results() << line.substr(1) << fmt::tag::eol;
+					}
+					else
+					{
+						fmt::out() << line << fmt::tag:: eol;
+					}
 				}
 			}
 		}
@@ -82,6 +97,7 @@ namespace
 			fmt::out() << "Unknown" << fmt::tag::eol;
 		}
 		fmt::out().rdbuf(back);
+		fmt::results().rdbuf(last);
 	}
 }
 
@@ -104,6 +120,7 @@ int main(int argc, char** argv)
 			tools = "tools",
 			print = "print",
 			quiet = "quiet",
+			bench = "bench",
 			host  = "host",
 			help  = "help";
 	} arg;
@@ -116,6 +133,7 @@ int main(int argc, char** argv)
 		{ {}, 0, "q", arg.quiet, "Only print error messages" },
 		{ {}, 0, "c", arg.color, "Print using color codes" },
 		{ {}, 0, "a", arg.async, "Run tests asynchronously" },
+		{ {}, 0, "b", arg.bench, "Run benchmarks instead of tests" },
 		{ {}, 1, "t", arg.tools, _TOOLS " is replaced with argument" },
 		{ {}, 0, "o", arg.host, "Host tests in this process" },
 	};
@@ -127,7 +145,9 @@ int main(int argc, char** argv)
 	const auto host  = env::opt::get(arg.host, false);
 	const auto color = env::opt::get(arg.color, not host);
 	const auto quiet = env::opt::get(arg.quiet, false);
-	const auto async = env::opt::get(arg.async, false);
+	const auto bench = env::opt::get(arg.bench, false);
+	// Benchmarks run alone so timings do not interfere
+	const auto async = not bench and env::opt::get(arg.async, false);
 	const auto tools = env::opt::get(arg.tools, config);
 	const auto clean = std::empty(env::opt::arguments());
 
@@ -150,16 +170,16 @@ int main(int argc, char** argv)
 	if (std::empty(tests))
 	{
 		static const auto list = env::opt::get(arg.tests);
-		for (const auto test : fmt::split(list, ";"))
+		for (const auto test : fmt::tokenize(list, ";"))
 		{
 			tests.emplace_back(test);
 		}
 	}
 
-	// Map test names to error buffers' string stream
-	std::map<fmt::string, std::stringstream> context;
+	// Map test names to error buffers' string stream, and to their results
+	std::map<fmt::string, std::stringstream> context, results;
 	const auto program = env::opt::program();
-	constexpr fmt::view prefix = "test_";
+	const fmt::view suffix = bench ? env::bench::suffix : env::test::suffix;
 
 	if (std::empty(tests))
 	{
@@ -167,10 +187,10 @@ int main(int argc, char** argv)
 		for (auto const& line : env::exe::exports(argv[0]))
 		{
 			// Separate lines by white space
-			for (auto const name : fmt::split(line))
+			for (auto const name : fmt::tokenize(line))
 			{
-				// Match those with prefix
-				if (name.starts_with(prefix))
+				// Match those with suffix
+				if (name.ends_with(suffix))
 				{
 					// Symbol must exist
 					const auto call = sys::sym<void()>(name);
@@ -230,7 +250,7 @@ int main(int argc, char** argv)
 			<< fmt::tag::eol << fmt::tag::tab
 			<< "3. The TESTS variable in " _TOOLS
 			<< fmt::tag::eol << fmt::tag::tab
-			<< "4. The dump symbols for " << prefix << "*"
+			<< "4. The dump symbols for *" << suffix
 			<< fmt::tag::eol
 			<< "Commands for unit test runner:"
 			<< fmt::tag::eol;
@@ -257,16 +277,17 @@ int main(int argc, char** argv)
 		for (auto const& [name, error] : context)
 		{
 			auto buf = error.rdbuf();
+			auto result = results[name].rdbuf();
 			if (async)
 			{
 				threads.emplace_back
 				(
-					std::async(std::launch::async, runner, name, buf, host)
+					std::async(std::launch::async, runner, name, buf, result, host)
 				);
 			}
 			else
 			{
-				runner(name, buf, host);
+				runner(name, buf, result, host);
 			}
 		}
 
@@ -280,6 +301,17 @@ int main(int argc, char** argv)
 	std::size_t counter = 0;
 	for (auto& [name, error] : context)
 	{
+		// Results are not errors, and indented when quiet for a parent runner
+		for (fmt::string str; std::getline(results[name], str); )
+		{
+			if (color)
+			{
+				std::cout << fmt::io::fg_off;
+			}
+
+			std::cout << (quiet ? fmt::tag::empty : fmt::view(name)) << fmt::tag::tab << str << fmt::tag::eol;
+		}
+
 		if (auto str = error.str(); not std::empty(str))
 		{
 			if (color)
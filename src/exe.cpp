@@ -10,27 +10,21 @@
 #include "dir.hpp"
 #include "type.hpp"
 #include "io.hpp"
+#include "mem.hpp"
+#include "format.hpp"
+#include "lines.hpp"
 
 namespace env::exe
 {
-	static thread_local fmt::string::set buf;
-
-	void clear()
+	fmt::lines get(fmt::input in, char end, int count)
 	{
-		buf.clear();
-	}
-
-	fmt::vector get(fmt::input in, char end, int count)
-	{
-		fmt::vector lines;
+		fmt::lines lines;
 		try
 		{
 			std::string line;
 			while (count-- and std::getline(in, line, end))
 			{
-				auto [it, unique] = buf.emplace(std::move(line));
-				(void) unique; // duplicates are okay
-				lines.emplace_back(it->data(), it->size());
+				lines.push_back(line);
 			}
 		}
 		catch (std::exception &error)
@@ -40,9 +34,10 @@ namespace env::exe
 		return lines;
 	}
 
-	fmt::vector get(fmt::span args)
+	fmt::lines get(fmt::span args)
 	{
-		fmt::string command;
+		fmt::scratch::scope scope;
+		fmt::scratch::string command;
 		for (auto arg : args)
 		{
 			const bool spaces = fmt::any_of(arg);
@@ -51,23 +46,24 @@ namespace env::exe
 			if (spaces) command += fmt::tag::quote;
 			command += " ";
 		}
-		fmt::istream in = env::file::open(command, env::file::ex);
+		const fmt::view line(command.data(), command.size());
+		fmt::istream in = env::file::open(line, env::file::ex);
 		const auto lines = get(in);
 		in.file.reset();
 		return lines;
 	}
 
-	fmt::vector get(fmt::init args)
+	fmt::lines get(fmt::init args)
 	{
 		return get(fwd::to_span(args));
 	}
 
-	fmt::vector echo(fmt::view line)
+	fmt::lines echo(fmt::view line)
 	{
 		return get({ "echo", line });
 	}
 
-	fmt::vector list(fmt::view name)
+	fmt::lines list(fmt::view name)
 	{
 		return get
 		(
@@ -79,7 +75,7 @@ namespace env::exe
 		);
 	}
 
-	fmt::vector copy(fmt::view path)
+	fmt::lines copy(fmt::view path)
 	{
 		return get
 		(
@@ -91,7 +87,7 @@ namespace env::exe
 		);
 	}
 
-	fmt::vector find(fmt::view pattern, fmt::view directory)
+	fmt::lines find(fmt::view pattern, fmt::view directory)
 	{
 		#ifdef _WIN32
 		{
@@ -104,7 +100,7 @@ namespace env::exe
 		#endif
 	}
 
-	fmt::vector which(fmt::view name)
+	fmt::lines which(fmt::view name)
 	{
 		return get
 		(
@@ -116,7 +112,7 @@ namespace env::exe
 		);
 	}
 
-	fmt::vector start(fmt::view path)
+	fmt::lines start(fmt::view path)
 	{
 		#ifdef _WIN32
 		{
@@ -136,20 +132,18 @@ namespace env::exe
 			{
 				if (session.empty() or desktop(session))
 				{
-					if (auto path = which(program); path.empty())
+					if (const auto found = which(program); not found.empty())
 					{
-						continue;
+						return get({ found.front(), path });
 					}
-
-					return get({ program, path });
 				}
 			}
-			return fmt::vector();
+			return fmt::lines();
 		}
 		#endif
 	}
 
-	fmt::vector imports(fmt::view path)
+	fmt::lines imports(fmt::view path)
 	{
 		return get
 		(
@@ -161,7 +155,7 @@ namespace env::exe
 		);
 	}
 
-	fmt::vector exports(fmt::view path)
+	fmt::lines exports(fmt::view path)
 	{
 		return get
 		(
@@ -176,9 +170,7 @@ namespace env::exe
 	bool desktop(fmt::view name)
 	{
 		const auto current = env::usr::current_desktop();
-		const auto lower = fmt::to_lower(current);
-		const auto find = fmt::to_lower(name);
-		return lower.find(name) != fmt::npos;
+		return fmt::ifind(current, name) != fmt::npos;
 	}
 
 	static fmt::vector pick()
@@ -202,22 +194,22 @@ namespace env::exe
 		return env::opt::get(entry, value);
 	}
 
-	fmt::vector dialog(fmt::param par)
+	fmt::lines dialog(fmt::param par)
 	{
 		// Look for any desktop utility program
-		fmt::view program;
+		fmt::lines path;
 		static const auto session = pick();
 		for (auto test : session)
 		{
-			if (auto path = which(test); not path.empty())
+			if (path = which(test); not path.empty())
 			{
-				program = path.front();
 				break;
 			}
 		}
-		program = pick(program);
+		const auto program = pick(path.empty() ? fmt::tag::empty : path.front());
 		// Append the command line
-		fmt::vector command;
+		fmt::scratch::scope scope;
+		fmt::scratch::vector command;
 		fmt::cache cache;
 		command.push_back(program);
 		for (auto pair : par)
@@ -228,11 +220,11 @@ namespace env::exe
 			#endif
 			command.emplace_back(it->data(), it->size());
 		}
-		return get(command);
+		return get(fmt::span(command));
 	}
 
 
-	fmt::vector select(fmt::view path, fmt::view mode)
+	fmt::lines select(fmt::view path, fmt::view mode)
 	{
 		fmt::edges command {{ "file-selection", fmt::tag::empty }};
 		if (not path.empty())
@@ -246,7 +238,7 @@ namespace env::exe
 		return dialog(command);
 	}
 
-	fmt::vector show(fmt::view text, fmt::view type)
+	fmt::lines show(fmt::view text, fmt::view type)
 	{
 		fmt::edges command {{ type, fmt::tag::empty }};
 		if (not text.empty())
@@ -256,7 +248,7 @@ namespace env::exe
 		return dialog(command);
 	}
 
-	fmt::vector enter(fmt::view start, fmt::view label, bool hide)
+	fmt::lines enter(fmt::view start, fmt::view label, bool hide)
 	{
 		fmt::edges command {{ "entry-text", start }};
 		if (not label.empty())
@@ -270,7 +262,7 @@ namespace env::exe
 		return dialog(command);
 	}
 
-	fmt::vector text(fmt::view path, fmt::view check, fmt::view font, fmt::view type)
+	fmt::lines text(fmt::view path, fmt::view check, fmt::view font, fmt::view type)
 	{
 		fmt::edges command {{ "text-info", fmt::tag::empty }};
 		if (type == "html")
@@ -298,7 +290,7 @@ namespace env::exe
 
 	}
 
-	fmt::vector form(fmt::param add, fmt::view text, fmt::view title)
+	fmt::lines form(fmt::param add, fmt::view text, fmt::view title)
 	{
 		fmt::edges command {{ "forms", fmt::tag::empty }};
 		if (not text.empty())
@@ -309,17 +301,17 @@ namespace env::exe
 		{
 			command.emplace_back("title", title);
 		}
-		fmt::string prefix { "add-" };
+		// Kept here since the command holds views until the dialog returns
+		fmt::cache keys;
 		for (auto ctl : add)
 		{
-			fmt::string copy = ctl.second;
-			auto key = prefix + copy;
-			command.emplace_back(key, ctl.first);
+			const auto it = keys.emplace(fmt::format<"add-{}">(ctl.second)).first;
+			command.emplace_back(*it, ctl.first);
 		}
 		return dialog(command);
 	}
 
-	fmt::vector notify(fmt::view text, fmt::view icon)
+	fmt::lines notify(fmt::view text, fmt::view icon)
 	{
 		fmt::edges command {{ "notification", fmt::tag::empty }};
 		if (not text.empty())
@@ -333,7 +325,7 @@ namespace env::exe
 		return dialog(command);
 	}
 
-	fmt::vector calendar(fmt::view text, fmt::view format, int day, int month, int year)
+	fmt::lines calendar(fmt::view text, fmt::view format, int day, int month, int year)
 	{
 		fmt::edges command {{ "calendar", fmt::tag::empty }};
 		if (not text.empty())
@@ -359,7 +351,7 @@ namespace env::exe
 		return dialog(command);
 	}
 
-	fmt::vector color(fmt::view start, bool palette)
+	fmt::lines color(fmt::view start, bool palette)
 	{
 		fmt::edges command {{"color-selection", fmt::tag::empty }};
 		if (not start.empty())
@@ -190,16 +190,12 @@ namespace env::file
 
 	bool fail(view u, mode mask)
 	{
-		if (not fmt::terminated(u))
-		{
-			auto buf = fmt::to_string(u);
-			return fail(buf, mask);
-		}
+		const fmt::cstr c(u);
 
 		#ifdef _WIN32
 		if (DWORD dw; mask & ex)
 		{
-			return GetBinaryType(u.data(), &dw)
+			return GetBinaryType(c.data(), &dw)
 				? success : failure;
 		}
 		#endif
@@ -225,10 +221,10 @@ namespace env::file
 				flags |= W_OK;
 			}
 
-			return sys::access(u.data(), flags);
+			return sys::access(c.data(), flags);
 		}
 
-		struct sys::stats state(u.data());
+		struct sys::stats state(c.data());
 		if (sys::fail(state.ok))
 		{
 			return failure;
@@ -310,11 +306,7 @@ namespace env::file
 
 	unique_ptr open(view u, mode mask)
 	{
-		if (not fmt::terminated(u))
-		{
-			auto buf = fmt::to_string(u);
-			return open(u, mask);
-		}
+		const fmt::cstr c(u);
 
 		#ifdef assert
 		assert((mask & (rwx|ok|un|app|fifo|bin|txt)) == mask);
@@ -326,11 +318,11 @@ namespace env::file
 
 			if (mask & wr)
 			{
-				f = sys::popen(u.data(), "w");
+				f = sys::popen(c.data(), "w");
 			}
 			else
 			{
-				f = sys::popen(u.data(), "r");
+				f = sys::popen(c.data(), "r");
 			}
 
 			if (nullptr == f)
@@ -354,7 +346,7 @@ namespace env::file
 		else
 		{
 			const auto mode = to_string(mask);
-			auto f = std::fopen(u.data(), mode.data());
+			auto f = std::fopen(c.data(), mode.data());
 			if (nullptr == f)
 			{
 				perror("fopen");
@@ -686,4 +678,87 @@ TEST(lock)
 	auto wrk = env::file::lock(f.get(), env::file::wo);
 	ASSERT(not wrk and "Lock file to write");
 }
+#include "io.hpp"
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
+TEST(fdbuf)
+{
+	// Small areas with large writes passing by
+	{
+		env::file::shared_ptr f = env::file::temp();
+		const int fd = sys::fileno(f.get());
+		const fmt::string big(1000, 'x');
+		{
+			fmt::ostream out(f, 16);
+			out << "first line\n" << 42 << '\n';
+			(void) out.write(big.data(), big.size());
+			out << "\nlast";
+		}
+		ASSERT(0 == sys::lseek(fd, 0, SEEK_SET));
+		fmt::istream in(fd, 16);
+		std::string line;
+		ASSERT(std::getline(in, line) and "first line" == line);
+		int n = 0;
+		ASSERT(in >> n and 42 == n);
+		ASSERT('\n' == in.get());
+		fmt::string back(big.size(), '\0');
+		ASSERT(in.read(back.data(), back.size()) and big == back);
+		ASSERT(std::getline(in, line) and line.empty());
+		ASSERT(std::getline(in, line) and "last" == line);
+		ASSERT(not std::getline(in, line));
+	}
+
+	// Writing after reading picks up where the reader stands
+	{
+		env::file::shared_ptr f = env::file::temp();
+		fmt::iostream io(f, 4);
+		io << "hello world" << std::flush;
+		ASSERT(io.seekg(0));
+		char word[5];
+		ASSERT(io.read(word, 5) and 5 == io.tellg());
+		io << "XYZ" << std::flush;
+		ASSERT(io.seekg(0));
+		std::string all;
+		ASSERT(std::getline(io, all) and "helloXYZrld" == all);
+	}
+
+	// Pipes with wide characters
+	{
+		struct sys::pipe p;
+		const std::wstring text = L"l'été 一";
+		{
+			fmt::wostream out(p[1]);
+			ASSERT(out << text << std::flush);
+		}
+		(void) sys::close(p[1]);
+		p[1] = sys::invalid;
+		fmt::wistream in(p[0], 3);
+		std::wstring back;
+		ASSERT(std::getline(in, back) and text == back);
+	}
+
+	#ifndef _WIN32
+	// Sockets keep what was read ahead across a write
+	{
+		int s[2];
+		ASSERT(0 == ::socketpair(AF_UNIX, SOCK_STREAM, 0, s));
+		const fmt::view text = "one\ntwo\n";
+		ASSERT(sys::write(s[1], text.data(), text.size()) == sys::ssize_t(text.size()));
+		{
+			fmt::iostream io(s[0], 16);
+			std::string line;
+			ASSERT(std::getline(io, line) and "one" == line);
+			ASSERT(-1 == io.tellg());
+			ASSERT(io << "ping" << std::flush);
+			ASSERT(std::getline(io, line) and "two" == line);
+		}
+		char back[4];
+		ASSERT(4 == sys::read(s[1], back, sizeof back));
+		ASSERT(fmt::view(back, sizeof back) == "ping");
+		(void) sys::close(s[0]);
+		(void) sys::close(s[1]);
+	}
+	#endif
+}
 #endif
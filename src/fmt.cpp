@@ -7,62 +7,247 @@
 #include "type.hpp"
 #include "char.hpp"
 #include "meta.hpp"
+#include "simd.hpp"
+#include "mo.hpp"
 #include <sstream>
 #include <iomanip>
 #include <charconv>
 #include <iostream>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <bit>
 #include <system_error>
+#include <climits>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
+#include <functional>
 
 namespace fmt::tag
 {
-	static sys::exclusive<fmt::string::set> cache;
+	namespace
+	{
+		struct entry
+		// Interned text with its hash and atom, never moved once placed
+		{
+			std::size_t hash;
+			view text;
+			atom id;
+		};
+
+		struct table
+		// Open addressing slots published to readers whole
+		{
+			std::unique_ptr<std::atomic<const entry*>[]> slots;
+			std::size_t mask;
+
+			explicit table(std::size_t size)
+			: slots(new std::atomic<const entry*>[size]), mask(size - 1)
+			{ }
+
+			const entry* find(view u, std::size_t hash) const
+			{
+				for (auto i = (hash >> 4) & mask; ; i = (i + 1) & mask)
+				{
+					const auto that = slots[i].load(std::memory_order_acquire);
+					if (nullptr == that or (that->hash == hash and that->text == u))
+					{
+						return that;
+					}
+				}
+			}
+
+			void place(const entry* that)
+			{
+				auto i = (that->hash >> 4) & mask;
+				while (nullptr != slots[i].load(std::memory_order_relaxed))
+				{
+					i = (i + 1) & mask;
+				}
+				slots[i].store(that, std::memory_order_release);
+			}
+		};
+
+		constexpr std::uint32_t shards = 16;
+		constexpr std::uint32_t first = 64; // entries in the first page
+		constexpr std::uint32_t pages = 21; // doubling, so ids fit 32 bits
+
+		struct shard
+		// Lock free readers, writers serialized on the mutex
+		{
+			std::atomic<const table*> now { nullptr };
+			std::deque<table> tables; // retired ones stay alive for readers
+			std::unique_ptr<entry[]> page[pages];
+			std::uint32_t count = 0;
+			fwd::vector<std::unique_ptr<char[]>> chunks;
+			char* next = nullptr;
+			std::size_t left = 0;
+			sys::mutex lock;
+
+			static auto locate(std::uint32_t n)
+			// Page and offset of the nth entry
+			{
+				n += first;
+				const auto k = std::bit_width(n) - std::bit_width(first);
+				return fwd::pair<std::uint32_t>(k, n - (first << k));
+			}
+
+			const entry& at(std::uint32_t n) const
+			{
+				const auto [k, i] = locate(n);
+				return page[k][i];
+			}
+
+			const entry* find(view u, std::size_t hash) const
+			{
+				const auto that = now.load(std::memory_order_acquire);
+				return nullptr == that ? nullptr : that->find(u, hash);
+			}
+
+			view copy(view u)
+			// Bump allocate in chunks so text never moves
+			{
+				constexpr std::size_t chunk = 1 << 16;
+				if (left < u.size())
+				{
+					const auto size = std::max(chunk, u.size());
+					chunks.emplace_back(new char[size]);
+					next = chunks.back().get();
+					left = size;
+				}
+				const auto data = next;
+				next = std::copy(u.begin(), u.end(), next);
+				left -= u.size();
+				return view(data, u.size());
+			}
+
+			const entry* insert(view u, std::size_t hash, std::uint32_t index)
+			{
+				auto that = now.load(std::memory_order_relaxed);
+				if (nullptr == that or that->mask < 2 * count + 1)
+				{
+					// Grow at half load and rehash into a new table
+					const auto size = nullptr == that ? 64 : 2 * (that->mask + 1);
+					auto& grown = tables.emplace_back(size);
+					for (std::uint32_t n = 0; n < count; ++n)
+					{
+						grown.place(&at(n));
+					}
+					now.store(that = &grown, std::memory_order_release);
+				}
+
+				const auto [k, i] = locate(count);
+				#ifdef assert
+				assert(k < pages);
+				#endif
+				if (0 == i)
+				{
+					page[k].reset(new entry[first << k]);
+				}
+
+				auto& it = page[k][i];
+				it.hash = hash;
+				it.text = copy(u);
+				// Zero is left for the empty atom
+				it.id.id = (++count * shards) | index;
+				const_cast<table*>(that)->place(&it);
+				return &it;
+			}
+		};
+
+		shard cache[shards];
+
+		const entry* lookup(view u)
+		{
+			const auto hash = std::hash<view>()(u);
+			const auto index = static_cast<std::uint32_t>(hash % shards);
+			auto& part = cache[index];
+			if (auto that = part.find(u, hash))
+			{
+				return that;
+			}
+			auto key = part.lock.key();
+			if (auto that = part.find(u, hash))
+			{
+				return that;
+			}
+			return part.insert(u, hash, index);
+		}
+	}
 
 	view emplace(view u)
 	{
-		auto key = cache.writer();
-		const auto begin = key->begin();
-		const auto end = key->end();
-		auto it = std::find_if(begin, end, fwd::equal_to(u));
-		if (end == it)
+		return lookup(u)->text;
+	}
+
+	atom intern(view u)
+	{
+		return u.empty() ? atom() : lookup(u)->id;
+	}
+
+	atom find(view u)
+	{
+		if (u.empty())
+		{
+			return atom();
+		}
+		const auto hash = std::hash<view>()(u);
+		const auto that = cache[hash % shards].find(u, hash);
+		return nullptr == that ? atom() : that->id;
+	}
+
+	view find(atom a)
+	{
+		if (0 == a.id)
 		{
-			auto pair = key->emplace(u);
-			#ifdef assert
-			assert(pair.second);
-			#endif
-			it = pair.first;
+			return empty;
 		}
-		return it->substr();
+		const auto& part = cache[a.id % shards];
+		return part.at(a.id / shards - 1).text;
 	}
 
-	input read(input in, char delim)
+	input read(input in, view delim)
 	{
 		fmt::string line;
-		auto key = cache.writer();
-		while (std::getline(in, line, delim))
+		while (in)
 		{
-			key->emplace(std::move(line));
+			line.clear();
+			fmt::getline(in, line, delim);
+			if (in or not line.empty())
+			{
+				(void) emplace(line);
+			}
 		}
 		return in;
 	}
 
-	output write(output out, char delim)
+	output write(output out, view delim)
 	{
-		auto key = cache.reader();
-		const auto begin = key->begin();
-		const auto end = key->end();
-		for (auto it = begin; it != end; ++it)
+		for (auto& part : cache)
 		{
-			out << *it << delim;
+			auto key = part.lock.key();
+			for (std::uint32_t n = 0; n < part.count; ++n)
+			{
+				out << part.at(n).text << delim;
+			}
 		}
 		return out;
 	}
 }
 
+namespace fmt
+{
+	view atom::str() const
+	{
+		return tag::find(*this);
+	}
+}
+
 namespace fmt::lang
 {
 	thread_local auto local = std::cout.getloc();
+	thread_local unsigned epoch = 0; // bumped on each set
 
 	const std::locale& get()
 	{
@@ -72,6 +257,7 @@ namespace fmt::lang
 	void set(std::locale& to)
 	{
 		local = to;
+		++ epoch;
 	}
 }
 
@@ -89,9 +275,232 @@ namespace fmt
 		}
 	}
 
+	template <class View> size_type locate(View u, View v, size_type pos)
+	// Same as View::find but vectorized for bytes
+	{
+		if constexpr (std::is_same<typename View::value_type, char>::value)
+		{
+			if (pos <= u.size())
+			{
+				const auto n = u.size() - pos;
+				const auto i = simd::find(u.data() + pos, n, v.data(), v.size());
+				return i < n or v.empty() ? pos + i : npos;
+			}
+			return npos;
+		}
+		else
+		{
+			return u.find(v, pos);
+		}
+	}
+
+	constexpr bool classic(int k, int c)
+	// Whether byte $c is in the $k'th class of the "C" locale
+	{
+		const bool upper = 'A' <= c and c <= 'Z';
+		const bool lower = 'a' <= c and c <= 'z';
+		const bool digit = '0' <= c and c <= '9';
+		const bool print = ' ' <= c and c < 0x7F;
+		const bool alnum = upper or lower or digit;
+		switch (k)
+		{
+		case 0: return upper;
+		case 1: return lower;
+		case 2: return upper or lower;
+		case 3: return digit;
+		case 4: return digit or ('a' <= (c | 0x20) and (c | 0x20) <= 'f');
+		case 5: return ' ' == c or ('\t' <= c and c <= '\r');
+		case 6: return print;
+		case 7: return print and ' ' != c;
+		case 8: return c < ' ' or 0x7F == c;
+		case 9: return print and ' ' != c and not alnum;
+		case 10: return alnum;
+		case 11: return ' ' == c or '\t' == c;
+		}
+		return false;
+	}
+
+	struct classic_table
+	// Masks of every byte in the "C" locale
+	{
+		mask at[256] = { };
+
+		constexpr classic_table()
+		{
+			// Some classes are unions of others, so only add the bits that
+			// no class excluding the byte has
+			constexpr mask k[]
+			{
+				std::ctype_base::upper, std::ctype_base::lower,
+				std::ctype_base::alpha, std::ctype_base::digit,
+				std::ctype_base::xdigit, std::ctype_base::space,
+				std::ctype_base::print, std::ctype_base::graph,
+				std::ctype_base::cntrl, std::ctype_base::punct,
+				std::ctype_base::alnum, std::ctype_base::blank,
+			};
+			for (int c = 0; c < 128; ++c)
+			{
+				mask out = 0;
+				for (int i = 0; i < 12; ++i)
+				{
+					if (not classic(i, c)) out |= k[i];
+				}
+				for (int i = 0; i < 12; ++i)
+				{
+					if (classic(i, c)) at[c] |= k[i] & ~out;
+				}
+			}
+		}
+	};
+
+	constexpr classic_table classic_masks;
+
+	template <class C> struct classes
+	// Masks of the first 256 code units in the thread locale
+	{
+		unsigned epoch = ~0u;
+		const std::ctype<C>* facet = nullptr;
+		mask at[256];
+
+		static const classes& get()
+		{
+			thread_local classes cache;
+			if (cache.epoch != lang::epoch)
+			{
+				const auto& loc = lang::get();
+				cache.facet = &std::use_facet<std::ctype<C>>(loc);
+				if (loc == std::locale::classic())
+				{
+					std::copy(classic_masks.at, classic_masks.at + 256, cache.at);
+				}
+				else
+				if constexpr (std::is_same<C, char>::value)
+				{
+					std::copy(cache.facet->table(), cache.facet->table() + 256, cache.at);
+				}
+				else
+				{
+					C c[256];
+					for (int n = 0; n < 256; ++n)
+					{
+						c[n] = static_cast<C>(n);
+					}
+					(void) cache.facet->is(c, c + 256, cache.at);
+				}
+				for (auto& slot : cache.sets)
+				{
+					slot.x = 0;
+				}
+				cache.epoch = lang::epoch;
+			}
+			return cache;
+		}
+
+		mask of(C c) const
+		{
+			const auto n = static_cast<std::make_unsigned_t<C>>(c);
+			if (n < 256)
+			{
+				return at[n];
+			}
+			mask x = 0;
+			(void) facet->is(&c, &c + 1, &x);
+			return x;
+		}
+
+		bool is(C c, mask x) const
+		{
+			return 0 != (of(c) & x);
+		}
+
+		const simd::charset& bytes(mask x) const
+		// Set of the bytes which are $x, cached for a few masks
+		{
+			auto& slot = sets[x % std::size(sets)];
+			if (slot.x != x)
+			{
+				slot.x = x;
+				slot.set = { };
+				for (int n = 0; n < 256; ++n)
+				{
+					if (at[n] & x) slot.set.insert(static_cast<unsigned char>(n));
+				}
+			}
+			return slot.set;
+		}
+
+	private:
+
+		mutable struct
+		{
+			mask x = 0;
+			simd::charset set;
+		}
+		sets[8];
+	};
+
+	template <class C> struct cases
+	// Case of the first 256 code units in the thread locale
+	{
+		unsigned epoch = ~0u;
+		const std::ctype<C>* facet = nullptr;
+		C upper[256], lower[256];
+		bool ascii = false; // lower case is plain ASCII folding
+
+		static const cases& get()
+		{
+			thread_local cases cache;
+			if (cache.epoch != lang::epoch)
+			{
+				cache.facet = &std::use_facet<std::ctype<C>>(lang::get());
+				for (int n = 0; n < 256; ++n)
+				{
+					cache.upper[n] = cache.lower[n] = static_cast<C>(n);
+				}
+				(void) cache.facet->toupper(cache.upper, cache.upper + 256);
+				(void) cache.facet->tolower(cache.lower, cache.lower + 256);
+				// High units must also stay high for vector compares
+				cache.ascii = true;
+				for (int n = 0; n < 256; ++n)
+				{
+					const auto c = static_cast<std::make_unsigned_t<C>>(cache.lower[n]);
+					const auto a = 'A' <= n and n <= 'Z' ? n | 0x20 : n;
+					cache.ascii = cache.ascii and (n < 128 ? a == c : 128 <= c);
+				}
+				cache.epoch = lang::epoch;
+			}
+			return cache;
+		}
+
+		C to_upper(C c) const
+		{
+			const auto n = static_cast<std::make_unsigned_t<C>>(c);
+			return n < 256 ? upper[n] : facet->toupper(c);
+		}
+
+		C to_lower(C c) const
+		{
+			const auto n = static_cast<std::make_unsigned_t<C>>(c);
+			return n < 256 ? lower[n] : facet->tolower(c);
+		}
+	};
+
 	template <class C> type<C>::catalog::catalog(view n)
 	{
 		const auto s = fmt::to_string(n);
+		if constexpr (std::is_same<C, char>::value)
+		{
+			// Read a GNU catalog in place when there is one
+			if (const auto path = mo::path(s, lang::get()); not path.empty())
+			{
+				table = std::make_unique<const mo>(path);
+				if (*table)
+				{
+					return;
+				}
+				table.reset();
+			}
+		}
 		id = use<messages>().open(s, lang::get());
 	}
 
@@ -102,33 +511,76 @@ namespace fmt
 
 	template <class C> type<C>::catalog::operator bool() const
 	{
-		return 0 < id;
+		return table or 0 < id;
 	}
 
 	template <class C> typename type<C>::view type<C>::catalog::operator()(view u, int set, int msgid)
 	{
-		auto it = fwd::find_if(cache, fwd::equal_to(u));
-		if (cache.end() == it)
+		if constexpr (std::is_same<C, char>::value)
+		{
+			// Immutable once mapped so a hit needs no lock
+			if (table)
+			{
+				if (const auto v = table->find(u); not v.empty())
+				{
+					return v;
+				}
+			}
+		}
+
+		const std::lock_guard key(lock);
+		if (const auto it = found.find(u); found.end() != it)
+		{
+			return it->second;
+		}
+		// Both kept in the cache as the caller's view may not last
+		string s { u.begin(), u.end() };
+		const view k = *cache.emplace(s).first;
+		if (not table)
 		{
-			string s { u.begin(), u.end() };
 			s = use<messages>().get(id, set, msgid, s);
-			std::tie(it, std::ignore) = cache.emplace(std::move(s));
 		}
-		return it->substr();
+		// An untranslated key is its own value
+		const view v = *cache.emplace(std::move(s)).first;
+		(void) found.emplace(k, v);
+		return v;
 	}
 
 	template <class C> bool type<C>::check(C c, mask x)
 	{
-		return use<ctype>().is(x, c);
+		return classes<C>::get().is(c, x);
 	}
 
 	template <class C> mark type<C>::check(view u)
 	{
 		mark x(u.size());
-		use<ctype>().is(u.data(), u.data() + u.size(), x.data());
+		const auto& table = classes<C>::get();
+		std::transform(u.begin(), u.end(), x.begin(), [&table](C c)
+		{
+			return table.of(c);
+		});
 		return x;
 	}
 
+	template <class C> bitmap type<C>::classify(view u, mask x)
+	{
+		const auto n = u.size();
+		bitmap b((n + 63) / 64);
+		const auto& table = classes<C>::get();
+		if constexpr (std::is_same<C, char>::value)
+		{
+			simd::classify(u.data(), n, table.bytes(x), b.data());
+		}
+		else
+		{
+			for (size_type i = 0; i < n; ++i)
+			{
+				if (table.is(u[i], x)) b[i / 64] |= std::uint64_t(1) << (i % 64);
+			}
+		}
+		return b;
+	}
+
 	template <class C> typename type<C>::iterator type<C>::next(iterator it, iterator end, mask x)
 	{
 		return scan_is(it, end, x);
@@ -152,25 +604,43 @@ namespace fmt
 	template <class C> typename type<C>::vector type<C>::split(view u, mask x)
 	{
 		vector t;
-		const auto begin = u.begin(), end = u.end();
-		for (auto i = skip(begin, end, x), j = end; i != end; i = skip(j, end, x))
+		for (const auto w : tokenize(u, x))
 		{
-			j = next(i, end, x);
-			const auto m = std::distance(begin, i);
-			const auto n = std::distance(i, j);
-			t.emplace_back(u.data() + m, n);
+			t.emplace_back(w);
 		}
 		return t;
 	}
 
+	template <class C> size_type type<C>::find(view u, mask x, size_type pos)
+	{
+		if (u.size() <= pos)
+		{
+			return npos;
+		}
+		const auto begin = u.begin() + pos, end = u.end();
+		const auto it = next(begin, end, x);
+		return end == it ? npos : pos + std::distance(begin, it);
+	}
+
+	template <class C> size_type type<C>::find_not(view u, mask x, size_type pos)
+	{
+		if (u.size() <= pos)
+		{
+			return npos;
+		}
+		const auto begin = u.begin() + pos, end = u.end();
+		const auto it = skip(begin, end, x);
+		return end == it ? npos : pos + std::distance(begin, it);
+	}
+
 	template <class C> typename type<C>::iterator type<C>::first(view u, mask x)
 	{
-		return scan_is(u.begin(), u.end(), x);
+		return scan_not(u.begin(), u.end(), x);
 	}
 
 	template <class C> typename type<C>::iterator type<C>::last(view u, mask x)
 	{
-		return scan_is(u.rbegin(), u.rend(), x).base() - 1;
+		return scan_not(u.rbegin(), u.rend(), x).base() - 1;
 	}
 
 	template <class C> typename type<C>::view type<C>::trim(view u, mask x)
@@ -207,26 +677,103 @@ namespace fmt
 
 	template <class C> typename type<C>::string type<C>::to_upper(view u)
 	{
-		string s;
-		const auto& facet = use<ctype>();
-		for (const auto w : widen(u))
-		{
-			const auto p = facet.toupper(w);
-			s += as_string<C>(p);
-		}
+		string s(u);
+		(void) to_upper(s.data(), s.data() + s.size());
 		return s;
 	}
 
 	template <class C> typename type<C>::string type<C>::to_lower(view u)
 	{
-		string s;
-		const auto& facet = use<ctype>();
-		for (const auto w : widen(u))
+		string s(u);
+		(void) to_lower(s.data(), s.data() + s.size());
+		return s;
+	}
+
+	template <class C> C* type<C>::to_upper(C* begin, C* end)
+	{
+		const auto& table = cases<C>::get();
+		for (auto it = begin; it != end; ++it)
 		{
-			const auto p = facet.tolower(w);
-			s += as_string<C>(p);
+			*it = table.to_upper(*it);
 		}
-		return s;
+		return end;
+	}
+
+	template <class C> C* type<C>::to_lower(C* begin, C* end)
+	{
+		const auto& table = cases<C>::get();
+		for (auto it = begin; it != end; ++it)
+		{
+			*it = table.to_lower(*it);
+		}
+		return end;
+	}
+
+	template <class C> bool type<C>::iequal(view u, view v)
+	{
+		const auto n = u.size();
+		if (v.size() != n)
+		{
+			return false;
+		}
+
+		const auto& table = cases<C>::get();
+		const auto same = [&table](C a, C b)
+		{
+			return table.to_lower(a) == table.to_lower(b);
+		};
+
+		if constexpr (std::is_same<C, char>::value)
+		{
+			if (table.ascii)
+			{
+				// Only a pair of high bytes can still match in the locale
+				const auto s = u.data(), t = v.data();
+				for (auto i = simd::iequal(s, t, n); i < n; i += simd::iequal(s + i, t + i, n - i))
+				{
+					if (not same(s[i], t[i]))
+					{
+						return false;
+					}
+					++ i;
+				}
+				return true;
+			}
+		}
+		return std::equal(u.begin(), u.end(), v.begin(), same);
+	}
+
+	template <class C> bool type<C>::istarts_with(view u, view v)
+	{
+		return v.size() <= u.size() and iequal(u.substr(0, v.size()), v);
+	}
+
+	template <class C> size_type type<C>::ifind(view u, view v, size_type pos)
+	{
+		if (u.size() < pos)
+		{
+			return npos;
+		}
+
+		const auto w = u.substr(pos);
+		const auto m = v.size();
+		if constexpr (std::is_same<C, char>::value)
+		{
+			// Vectors fold ASCII only which high bytes cannot match
+			if (cases<C>::get().ascii and m == simd::ascii(v.data(), m))
+			{
+				const auto i = simd::ifind(w.data(), w.size(), v.data(), m);
+				return w.size() < i + m ? npos : pos + i;
+			}
+		}
+		for (size_type i = 0; i + m <= w.size(); ++i)
+		{
+			if (iequal(w.substr(i, m), v))
+			{
+				return pos + i;
+			}
+		}
+		return npos;
 	}
 
 	template <class C> typename type<C>::pair type<C>::to_pair(view u, view v)
@@ -245,54 +792,87 @@ namespace fmt
 
 	template <class C> size_type type<C>::count(view u, view v)
 	{
-		auto n = null;
-		const auto z = v.size();
-		for (auto i = u.find(v); i != npos; i = u.find(v, i))
+		if constexpr (std::is_same<C, char>::value)
 		{
-			i += z;
-			++ n;
+			return simd::count(u.data(), u.size(), v.data(), v.size());
+		}
+		else
+		{
+			auto n = null;
+			const auto z = v.size();
+			if (0 == z) return n;
+			for (auto i = u.find(v); i != npos; i = u.find(v, i))
+			{
+				i += z;
+				++ n;
+			}
+			return n;
 		}
-		return n;
 	}
 
-	template <class C> typename type<C>::string type<C>::join(span t, view u)
+	template <class C> typename type<C>::string type<C>::join(const_span t, view u)
 	{
 		string s;
-		const auto begin = t.begin();
-		const auto end = t.end();
-		for (auto it = begin; it != end; ++it)
+		(void) join_to(s, t, u);
+		return s;
+	}
+
+	template <class C> size_type type<C>::join_size(const_span t, view u)
+	{
+		size_type n = t.empty() ? 0 : u.size() * (t.size() - 1);
+		for (const auto& v : t)
 		{
-			if (begin != it)
-			{
-				s += u;
-			}
-			s += *it;
+			n += v.size();
 		}
+		return n;
+	}
+
+	template <class C> typename type<C>::string& type<C>::join_to(string& s, const_span t, view u)
+	{
+		// A part inside $s would be overwritten before it is copied
+		const auto inside = [first = s.data(), last = s.data() + s.capacity()](view v)
+		{
+			const std::less<const C*> less;
+			return not v.empty() and not less(v.data(), first) and less(v.data(), last);
+		};
+		if (inside(u) or std::any_of(t.begin(), t.end(), inside))
+		{
+			s = join(t, u);
+			return s;
+		}
+		s.resize(join_size(t, u));
+		(void) join_to(s.data(), t, u);
 		return s;
 	}
 
 	template <class C> typename type<C>::vector type<C>::split(view u, view v)
 	{
 		vector t;
-		const auto uz = u.size(), vz = v.size();
-		for (auto i = null, j = u.find(v); i < uz; j = u.find(v, i))
+		for (const auto w : tokenize(u, v))
 		{
-			const auto k = uz < j ? uz : j;
-			const auto w = u.substr(i, k - i);
-			if (i <= k) t.emplace_back(w);
-			i = k + vz;
+			t.emplace_back(w);
 		}
 		return t;
 	}
 
+	template <class C> size_type type<C>::find(view u, view v, size_type pos)
+	{
+		return locate(u, v, pos);
+	}
+
 	template <class C> typename type<C>::string type<C>::replace(view u, view v, view w)
 	{
 		string s;
 		const auto uz = u.size(), vz = v.size();
-		for (auto i = null, j = u.find(v); i < uz; j = u.find(v, i))
+		if (0 == vz)
+		{
+			return string(u);
+		}
+		s.reserve(uz);
+		for (auto i = null, j = locate(u, v, i); i < uz; j = locate(u, v, i))
 		{
 			const auto k = std::min(j, uz);
-			s = u.substr(i, k - i);
+			s += u.substr(i, k - i);
 			if (j < uz) s += w;
 			i = k + vz;
 		}
@@ -334,8 +914,8 @@ namespace fmt
 
 	template <class C> C type<C>::getline(input in, string& line, view delims)
 	{
-		C byte;
-		while (in.get(byte) and delims.find(byte) < fmt::npos)
+		C byte { };
+		while (in.get(byte) and delims.find(byte) == fmt::npos)
 		{
 			line.push_back(byte);
 		}
@@ -356,32 +936,37 @@ namespace fmt
 
 	template <class C> size_type type<C>::length(view u)
 	{
-		size_type n = 0;
-		while (not u.empty())
+		if constexpr (std::is_same<C, char>::value)
 		{
-			const auto c = u.front();
-			const auto m = length(c);
-			u = u.substr(m);
-			n += m;
+			return utf::count(u);
+		}
+		else
+		if constexpr (sizeof(C) < sizeof(char32_t))
+		{
+			// Low surrogates finish a pair
+			return u.size() - std::count_if(u.begin(), u.end(), [](C c)
+			{
+				return 0xDC00 <= c and c < 0xE000;
+			});
+		}
+		else
+		{
+			return u.size();
 		}
-		return n;
 	}
 
 	template <class C> template <class It> It type<C>::scan_is(It it, It end, mask x)
 	{
-		if constexpr (std::is_same<It, pointer>::value)
+		const auto& table = classes<C>::get();
+		if constexpr (std::is_same<It, pointer>::value and std::is_same<C, char>::value)
 		{
-			return use<ctype>().scan_is(x, it, end);
+			return it + simd::find_in(it, end - it, table.bytes(x));
 		}
 		else
 		{
-			while (it != end)
+			while (it != end and not table.is(*it, x))
 			{
-				if (check(*it, x))
-				{
-					break;
-				}
-				else ++it;
+				++it;
 			}
 			return it;
 		}
@@ -389,19 +974,16 @@ namespace fmt
 
 	template <class C> template <class It> It type<C>::scan_not(It it, It end, mask x)
 	{
-		if constexpr (std::is_same<It, pointer>::value)
+		const auto& table = classes<C>::get();
+		if constexpr (std::is_same<It, pointer>::value and std::is_same<C, char>::value)
 		{
-			return use<ctype>().scan_not(x, it, end);
+			return it + simd::find_not_in(it, end - it, table.bytes(x));
 		}
 		else
 		{
-			while (it != end)
+			while (it != end and table.is(*it, x))
 			{
-				if (check(*it, x))
-				{
-					++it;
-				}
-				else break;
+				++it;
 			}
 			return it;
 		}
@@ -413,6 +995,7 @@ namespace fmt
 
 
 #ifdef TEST
+#include <random>
 
 TEST(type)
 {
@@ -431,6 +1014,41 @@ TEST(type)
 		ASSERT('!' == *fmt::last(Filled));
 	}
 
+	// Character class tables agree with the facet
+	{
+		const auto& facet = std::use_facet<std::ctype<char>>(fmt::lang::get());
+		for (const auto x : { fmt::space, fmt::alpha, fmt::digit, fmt::punct, fmt::graph })
+		{
+			for (int c = CHAR_MIN; c <= CHAR_MAX; ++c)
+			{
+				ASSERT(facet.is(x, static_cast<char>(c)) == fmt::type<char>::check(static_cast<char>(c), x));
+			}
+		}
+		const auto mark = fmt::type<char>::check(Filled);
+		ASSERT(mark.size() == Filled.size());
+		ASSERT(mark.front() & fmt::space);
+	}
+
+	// Bitmap of a character class
+	{
+		const auto b = fmt::classify(Filled);
+		fmt::size_type n = 0;
+		for (const auto i : fmt::ones(b))
+		{
+			ASSERT(fmt::type<char>::check(Filled[i]));
+			++ n;
+		}
+		ASSERT(n == 2 * Space.size() + 1);
+		const auto d = fmt::classify("a1b22", fmt::digit);
+		fmt::size_type k = 0;
+		for (const auto i : fmt::ones(d))
+		{
+			ASSERT(i == 1 or i == 3 or i == 4);
+			++ k;
+		}
+		ASSERT(3 == k);
+	}
+
 	// Trimming whitespace
 	{
 		ASSERT(fmt::trim(Space).empty());
@@ -454,23 +1072,123 @@ TEST(type)
 		}
 	}
 
+	// Split and count by substring
+	{
+		const fmt::view Path = "/usr/local/bin::/usr/bin:";
+		const auto t = fmt::split(Path, ":");
+		ASSERT(t.size() == 3);
+		ASSERT(t[0] == "/usr/local/bin");
+		ASSERT(t[1].empty());
+		ASSERT(t[2] == "/usr/bin");
+		ASSERT(fmt::count(Path, ":") == 3);
+		ASSERT(fmt::count(Path, "/usr") == 2);
+		ASSERT(fmt::replace(Path, "/usr", "~") == "~/local/bin::~/bin:");
+	}
+
+	// Join with the size known in advance
+	{
+		const fmt::view::vector t { "usr", "local", "bin" };
+		const auto s = fmt::join(t, "/");
+		ASSERT(s == "usr/local/bin");
+		ASSERT(fmt::join_size(t, "/") == s.size());
+
+		fmt::string buf = "stale contents of the buffer";
+		ASSERT(fmt::join_to(buf, t, "::") == "usr::local::bin");
+		buf.reserve(64);
+		const fmt::view::vector self { buf, "sbin", fmt::view(buf).substr(5) };
+		ASSERT(fmt::join_to(buf, self, "/") == "usr::local::bin/sbin/local::bin");
+
+		char c[16] = { };
+		const auto end = fmt::join_to(c, t, ".");
+		ASSERT(fmt::view(c, end - c) == "usr.local.bin");
+		ASSERT(fmt::join(fmt::view::vector { }, "/").empty());
+	}
+
+	// Lazy tokens agree with split
+	{
+		const fmt::view Path = "/usr/local/bin::/usr/bin:";
+		const auto t = fmt::split(Path, ":");
+		auto it = t.begin();
+		for (const auto u : fmt::tokenize(Path, ":"))
+		{
+			ASSERT(it != t.end() and *it == u);
+			++ it;
+		}
+		ASSERT(it == t.end());
+
+		fmt::size_type n = 0;
+		for (const auto u : fmt::tokenize(" 1 2\t3 "))
+		{
+			ASSERT(1 == u.size());
+			++ n;
+		}
+		ASSERT(3 == n);
+		ASSERT(fmt::split(" \t").empty());
+		ASSERT(fmt::split("", ":").empty());
+	}
+
 	// String view null terminator
 	{
 		ASSERT(fmt::terminated(Hello));
 		auto substr = Hello.substr(0, 5);
 		ASSERT(not fmt::terminated(substr));
+
+		// Views are copied while strings and pointers are used in place
+		const fmt::cstr whole(Hello);
+		ASSERT(whole.data() != Hello.data() and fmt::view(whole) == Hello);
+		const fmt::string owned(Hello);
+		ASSERT(fmt::cstr(owned).data() == owned.data());
+		ASSERT(fmt::cstr(owned.c_str()).data() == owned.data());
+		const fmt::cstr part(substr);
+		ASSERT(part.data() != substr.data());
+		ASSERT(fmt::view(part) == substr);
+		const fmt::string big(2 * FILENAME_MAX, 'x');
+		const fmt::cstr large(fmt::view(big).substr(1));
+		ASSERT(std::strlen(large) == big.size() - 1);
+		ASSERT(0 == *fmt::cstr(fmt::view()).data());
 	}
 
 	// Character case conversion
 	{
 		ASSERT(fmt::to_upper(Hello) == Upper);
 		ASSERT(fmt::to_lower(Hello) == Lower);
+
+		fmt::string s(Hello);
+		(void) fmt::to_upper(s.data(), s.data() + s.size());
+		ASSERT(s == Upper);
+		(void) fmt::to_lower(s.data(), s.data() + s.size());
+		ASSERT(s == Lower);
+	}
+
+	// Comparison and search ignoring case
+	{
+		ASSERT(fmt::iequal(Hello, Upper));
+		ASSERT(fmt::iequal(Lower, Upper));
+		ASSERT(not fmt::iequal(Hello, Upper.substr(1)));
+		ASSERT(fmt::istarts_with(Hello, "HELLO"));
+		ASSERT(not fmt::istarts_with("He", Hello));
+		ASSERT(fmt::ifind(Hello, "world") == 7);
+		ASSERT(fmt::ifind(Hello, "WORLD", 8) == fmt::npos);
+		ASSERT(fmt::ifind(Hello, "") == 0);
+		ASSERT(fmt::ifind("KDE:plasma", "kde") == 0);
+		// Long enough to reach the vector loops
+		fmt::string Long = Filled;
+		Long += Filled;
+		Long = fmt::to_upper(Long);
+		ASSERT(fmt::ifind(Long, "world!") == Long.find("WORLD!"));
+		ASSERT(fmt::ifind(Long, "world!", Long.size() / 2) == Long.rfind("WORLD!"));
+		ASSERT(fmt::iequal(Long, fmt::to_lower(Long)));
+		ASSERT(fmt::type<wchar_t>::iequal(L"Hello", L"hELLO"));
+		ASSERT(fmt::type<wchar_t>::ifind(L"Hello", L"LL") == 2);
 	}
 
 	// Character encoding conversion
 	{
 		ASSERT(fmt::to_wstring(Hello) == Wide);
 		ASSERT(fmt::to_string(Wide) == Hello);
+		ASSERT(fmt::to_wstring(fmt::view("\xE2\x82\xAC")) == L"\u20AC");
+		ASSERT(fmt::to_string(fmt::wide(L"\u20AC")) == "\xE2\x82\xAC");
+		ASSERT(3 == fmt::type<char>::length(fmt::view("a\xE2\x82\xAC\xC3\xAF")));
 	}
 
 	// Search matching braces
@@ -507,6 +1225,171 @@ TEST(fmt)
 	ASSERT(s == msg);
 }
 
+TEST(hash)
+{
+	// Owned strings are found by any view of the same text
+	fmt::string::hash_set names { "alpha", "beta", "gamma" };
+	ASSERT(names.contains(fmt::view("beta")));
+	ASSERT(names.contains("gamma"));
+	ASSERT(not names.contains("delta"));
+	ASSERT(1 == names.erase(fmt::view("alpha")));
+	ASSERT(2 == names.size());
+
+	// Grow past many groups with deletions in between
+	fmt::view::hash_map index;
+	fmt::string::set text;
+	for (int n = 0; n < 1000; ++n)
+	{
+		const fmt::view u = *text.emplace(fmt::to_string(n)).first;
+		index[u] = u;
+	}
+	for (int n = 0; n < 1000; n += 3)
+	{
+		ASSERT(1 == index.erase(fmt::to_string(n)));
+	}
+	for (int n = 0; n < 1000; ++n)
+	{
+		const auto s = fmt::to_string(n);
+		const auto it = index.find(s);
+		ASSERT((0 == n % 3) == (index.end() == it));
+		ASSERT(index.end() == it or it->second == s);
+	}
+	fmt::size_type k = 0;
+	for (const auto& [key, value] : index)
+	{
+		ASSERT(key == value);
+		++ k;
+	}
+	ASSERT(k == index.size());
+}
+
+TEST(flat)
+{
+	// Bulk construction sorts and keeps the first of equal keys
+	fmt::view::flat_map map { { "gamma", "3" }, { "alpha", "1" }, { "beta", "2" }, { "alpha", "one" } };
+	ASSERT(3 == map.size());
+	ASSERT(map.find("alpha")->second == "1");
+	ASSERT(map.begin()->first == "alpha");
+	ASSERT(map.end() == map.find("delta"));
+	ASSERT(map.lower_bound("b")->first == "beta");
+
+	// Changes keep the order
+	ASSERT(map.try_emplace("delta", "4").second);
+	ASSERT(not map.try_emplace("beta", "two").second);
+	map["epsilon"] = "5";
+	ASSERT(1 == map.erase("gamma"));
+	ASSERT(0 == map.erase("gamma"));
+	ASSERT(std::is_sorted(map.begin(), map.end()));
+	ASSERT(4 == map.size() and map.contains("epsilon"));
+
+	fmt::string::flat_set names { "b", "c", "a", "b" };
+	ASSERT(3 == names.size());
+	ASSERT(names.insert("d").second and not names.insert("a").second);
+	ASSERT(names.begin()->front() == 'a');
+
+	// Constant tables are sorted when compiled
+	using entry = fwd::pair<std::string_view, int>;
+	static constexpr entry table[] = { { "two", 2 }, { "one", 1 }, { "three", 3 } };
+	static constexpr fwd::static_map numbers(table);
+	static_assert(numbers.unique());
+	static_assert(numbers.begin()->first == "one");
+	static_assert(2 == numbers.find(std::string_view("two"))->second);
+	static_assert(not numbers.contains(std::string_view("four")));
+	ASSERT(numbers.contains(fmt::view("three")));
+}
+
+TEST(string_sort)
+{
+	const fmt::string::vector text
+	{
+		"/usr/share/doc", "/usr/bin", "/usr", "", "/usr/share", "/etc/xdg", "/usr/bin", "/usr/lib64", "/usr/lib"
+	};
+	fmt::vector t(text.begin(), text.end()), u = t;
+	std::sort(u.begin(), u.end());
+	fwd::string_sort(fmt::span(t));
+	ASSERT(t == u);
+
+	// Enough to take the radix passes and keep equal keys in order
+	fwd::vector<fwd::pair<fmt::view, int>> p;
+	for (int n = 0; n < 3000; ++n)
+	{
+		p.emplace_back(text[n % text.size()], n);
+	}
+	auto q = p;
+	const auto first = [](const auto& x)
+	{
+		return x.first;
+	};
+	fwd::stable_string_sort(fwd::span(p), first);
+	std::stable_sort(q.begin(), q.end(), [](const auto& x, const auto& y)
+	{
+		return x.first < y.first;
+	});
+	ASSERT(p == q);
+	fwd::parallel_string_sort(fwd::span(p), false, first);
+	ASSERT(std::is_sorted(p.begin(), p.end(), [](const auto& x, const auto& y)
+	{
+		return x.first < y.first;
+	}));
+
+	// Nested prefixes give one bucket per length, which must not recurse as deep
+	fmt::string::vector nest;
+	for (int n = 1; n <= 4000; ++n)
+	{
+		nest.emplace_back(n, 'a');
+	}
+	std::mt19937 rng(42);
+	std::shuffle(nest.begin(), nest.end(), rng);
+	fmt::vector v(nest.begin(), nest.end()), w = v;
+	fwd::stable_string_sort(fmt::span(v));
+	std::sort(w.begin(), w.end());
+	ASSERT(v == w);
+
+	// Enough for the buckets to be sorted in threads, both ways
+	fmt::string::vector many;
+	for (int n = 0; n < 80000; ++n)
+	{
+		many.emplace_back(text[n % text.size()] + fmt::to_string(n * 7919 % 80000));
+	}
+	for (const bool stable : { false, true })
+	{
+		fmt::vector x(many.begin(), many.end()), y = x;
+		fwd::parallel_string_sort(fmt::span(x), stable);
+		std::sort(y.begin(), y.end());
+		ASSERT(x == y);
+	}
+}
+
+TEST(tag)
+{
+	const fmt::string s = "interned";
+	const auto u = fmt::tag::emplace(s);
+	const auto v = fmt::tag::emplace("interned");
+	ASSERT(u.data() == v.data());
+	ASSERT(u == s);
+
+	std::stringstream in("alpha\nbeta\n");
+	fmt::tag::read(in);
+	std::stringstream out;
+	fmt::tag::write(out);
+	const auto w = out.str();
+	ASSERT(w.find("alpha\n") != fmt::npos);
+	ASSERT(w.find("interned\n") != fmt::npos);
+	ASSERT(fmt::tag::emplace("beta").data() == fmt::tag::emplace("beta").data());
+
+	const auto a = fmt::tag::intern("alpha");
+	const auto b = fmt::tag::intern(fmt::string("alpha"));
+	ASSERT(a == b and a.str() == "alpha");
+	ASSERT(a != fmt::tag::intern("beta"));
+	ASSERT(fmt::tag::intern("") == fmt::atom());
+	ASSERT(fmt::tag::find("alpha") == a);
+	ASSERT(fmt::tag::find("never interned") == fmt::atom());
+	std::stringstream all;
+	fmt::tag::write(all);
+	ASSERT(all.str().find("never interned") == fmt::npos);
+	ASSERT(fmt::view(fmt::atom()).empty());
+}
+
 TEST(lang)
 {
 	auto de = std::locale("de_DE.utf8");
@@ -517,6 +1400,10 @@ TEST(lang)
 	ASSERT(txt == "Keine Übereinstimmung");
 	const auto txt2 = cat("Memory exhausted");
 	ASSERT(txt2 == "Speicher erschöpft");
+	fmt::string s = "Not in any catalog";
+	const auto txt3 = cat(s);
+	ASSERT(txt3 == s and txt3.data() != s.data());
+	ASSERT(cat(s).data() == txt3.data());
 }
 
 #endif
@@ -0,0 +1,128 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "lines.hpp"
+#include "type.hpp"
+
+namespace fmt
+{
+	lines::lines(const lines& that)
+	: text(that.text), items(that.items)
+	{
+		rebase(that.text.data(), text.data());
+	}
+
+	lines& lines::operator=(const lines& that)
+	{
+		if (this != &that)
+		{
+			text = that.text;
+			items = that.items;
+			rebase(that.text.data(), text.data());
+		}
+		return *this;
+	}
+
+	lines::lines(const_span t)
+	{
+		size_type bytes = 0;
+		for (const auto u : t)
+		{
+			bytes += u.size();
+		}
+		reserve(t.size(), bytes);
+		for (const auto u : t)
+		{
+			push_back(u);
+		}
+	}
+
+	void lines::rebase(const char* from, const char* to)
+	{
+		for (auto& u : items)
+		{
+			u = view(to + (u.data() - from), u.size());
+		}
+	}
+
+	void lines::push_back(view u)
+	{
+		const auto at = text.size();
+		const auto size = u.size() + 1;
+		if (text.capacity() - at < size)
+		{
+			// Offsets are taken before the old buffer goes
+			fwd::vector<char> next;
+			next.reserve(std::max(2 * text.capacity(), at + size));
+			next.assign(text.begin(), text.end());
+			rebase(text.data(), next.data());
+			text.swap(next);
+		}
+		// Input inside the old buffer is still alive here
+		text.resize(at + size);
+		std::copy(u.begin(), u.end(), text.begin() + at);
+		text.back() = '\0';
+		items.emplace_back(text.data() + at, u.size());
+	}
+
+	void lines::reserve(size_type count, size_type bytes)
+	{
+		items.reserve(count);
+		bytes += count;
+		if (text.capacity() < bytes)
+		{
+			fwd::vector<char> next;
+			next.reserve(bytes);
+			next.assign(text.begin(), text.end());
+			rebase(text.data(), next.data());
+			text.swap(next);
+		}
+	}
+}
+
+#ifdef TEST
+TEST(lines)
+{
+	// Views stay valid as the buffer grows
+	fmt::lines t;
+	for (int n = 0; n < 1000; ++n)
+	{
+		t.push_back(fmt::to_string(n));
+	}
+	ASSERT(1000 == t.size());
+	ASSERT(t.front() == "0" and t.back() == "999");
+	for (int n = 0; n < 1000; ++n)
+	{
+		ASSERT(t[n] == fmt::to_string(n));
+	}
+
+	// Moves keep the buffer and copies get their own
+	const auto data = t.front().data();
+	fmt::lines u = std::move(t);
+	ASSERT(u.front().data() == data);
+	fmt::lines v = u;
+	ASSERT(v.front().data() != data);
+	ASSERT(fmt::join(v, ",") == fmt::join(u, ","));
+
+	// Empty lines and a span
+	const fmt::vector w { "a", "", "c" };
+	const fmt::lines x = fmt::const_span(w);
+	ASSERT(3 == x.size() and x[1].empty());
+	ASSERT(fmt::join(x, "/") == "a//c");
+
+	// Each line is followed by a null outside its view
+	for (const auto u : x)
+	{
+		ASSERT('\0' == u.data()[u.size()]);
+	}
+	fmt::lines y;
+	y.reserve(2, 3);
+	y.push_back("ab");
+	y.push_back("c");
+	ASSERT('\0' == y[0].data()[2] and y[1].data() == y[0].data() + 3);
+	ASSERT('\0' == y.back().data()[1]);
+	u.clear();
+	ASSERT(u.empty());
+}
+#endif
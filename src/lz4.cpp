@@ -0,0 +1,718 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "lz4.hpp"
+#include <algorithm>
+#include <cstring>
+#include <bit>
+
+namespace
+{
+	constexpr std::uint32_t magic = 0x184D2204;
+	constexpr std::uint32_t skippable = 0x184D2A50; // low four bits vary
+	constexpr std::uint32_t raw = 0x80000000; // block stored as is
+	constexpr std::size_t window = 1 << 16; // farthest a match reaches back
+	constexpr std::size_t slack = 32; // room for copies that run over
+	constexpr std::size_t minmatch = 4;
+	constexpr std::size_t mflimit = 12; // no match starts closer to the end
+	constexpr std::size_t lastliterals = 5; // and none ends closer
+	constexpr int bits = 12; // of the match table
+
+	constexpr std::uint32_t prime[] =
+	{
+		2654435761U, 2246822519U, 3266489917U, 668265263U, 374761393U
+	};
+
+	std::uint32_t read32(const unsigned char* p)
+	{
+		std::uint32_t w;
+		std::memcpy(&w, p, sizeof w);
+		return w;
+	}
+
+	std::uint64_t read64(const unsigned char* p)
+	{
+		std::uint64_t w;
+		std::memcpy(&w, p, sizeof w);
+		return w;
+	}
+
+	std::uint32_t le32(const unsigned char* p)
+	{
+		return p[0] | p[1] << 8 | p[2] << 16 | std::uint32_t(p[3]) << 24;
+	}
+
+	void le32(unsigned char* p, std::uint32_t w)
+	{
+		for (int n = 0; n < 4; ++n, w >>= 8)
+		{
+			p[n] = static_cast<unsigned char>(w);
+		}
+	}
+
+	std::uint32_t round(std::uint32_t acc, std::uint32_t in)
+	{
+		acc += in * prime[1];
+		return std::rotl(acc, 13) * prime[0];
+	}
+
+	std::uint32_t hash(std::uint32_t seq)
+	{
+		return (seq * prime[0]) >> (32 - bits);
+	}
+
+	std::size_t common(const unsigned char* p, const unsigned char* q, std::size_t n)
+	// Length of the equal prefix of $p and $q up to $n, a word at a time
+	{
+		std::size_t k = 0;
+		for (; k + 8 <= n; k += 8)
+		{
+			if (const auto diff = read64(p + k) ^ read64(q + k); 0 != diff)
+			{
+				if constexpr (std::endian::little == std::endian::native)
+				{
+					return k + std::countr_zero(diff) / 8;
+				}
+				else
+				{
+					return k + std::countl_zero(diff) / 8;
+				}
+			}
+		}
+		while (k < n and p[k] == q[k])
+		{
+			++ k;
+		}
+		return k;
+	}
+
+	unsigned char* length(unsigned char* op, std::size_t n)
+	// Bytes of 255 then the rest for a length past the nibble
+	{
+		for (; 255 <= n; n -= 255)
+		{
+			*op++ = 255;
+		}
+		*op++ = static_cast<unsigned char>(n);
+		return op;
+	}
+}
+
+namespace fmt
+{
+	xxh32::xxh32(std::uint32_t seed)
+	: v { seed + prime[0] + prime[1], seed + prime[1], seed, seed - prime[0] }
+	{ }
+
+	void xxh32::update(const void* data, std::size_t size)
+	{
+		auto p = static_cast<const unsigned char*>(data);
+		total += size;
+
+		// Top up a partial stripe first
+		if (0 < used)
+		{
+			const auto n = std::min(size, sizeof mem - used);
+			std::memcpy(mem + used, p, n);
+			used += n;
+			p += n;
+			size -= n;
+			if (used < sizeof mem)
+			{
+				return;
+			}
+			for (int k = 0; k < 4; ++k)
+			{
+				v[k] = round(v[k], read32(mem + 4 * k));
+			}
+			used = 0;
+		}
+
+		for (; 16 <= size; p += 16, size -= 16)
+		{
+			for (int k = 0; k < 4; ++k)
+			{
+				v[k] = round(v[k], read32(p + 4 * k));
+			}
+		}
+
+		std::memcpy(mem, p, size);
+		used = size;
+	}
+
+	std::uint32_t xxh32::digest() const
+	{
+		std::uint32_t h = 16 <= total
+			? std::rotl(v[0], 1) + std::rotl(v[1], 7) + std::rotl(v[2], 12) + std::rotl(v[3], 18)
+			: v[2] + prime[4];
+		h += static_cast<std::uint32_t>(total);
+
+		std::size_t k = 0;
+		for (; k + 4 <= used; k += 4)
+		{
+			h += read32(mem + k) * prime[2];
+			h = std::rotl(h, 17) * prime[3];
+		}
+		for (; k < used; ++k)
+		{
+			h += mem[k] * prime[4];
+			h = std::rotl(h, 11) * prime[0];
+		}
+
+		h ^= h >> 15;
+		h *= prime[1];
+		h ^= h >> 13;
+		h *= prime[2];
+		h ^= h >> 16;
+		return h;
+	}
+
+	std::uint32_t xxh32::of(const void* data, std::size_t size, std::uint32_t seed)
+	{
+		xxh32 that(seed);
+		that.update(data, size);
+		return that.digest();
+	}
+}
+
+namespace fmt::lz4
+{
+	std::size_t bound(std::size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	std::size_t pack(const char* in, std::size_t size, char* out, std::uint32_t* table)
+	{
+		const auto src = reinterpret_cast<const unsigned char*>(in);
+		const auto dst = reinterpret_cast<unsigned char*>(out);
+		auto op = dst;
+		std::size_t anchor = 0;
+
+		auto emit = [&](std::size_t offset, std::size_t match, std::size_t end)
+		// Literals from the anchor to $end then a match unless it is the last
+		{
+			const auto lit = end - anchor;
+			const auto token = op++;
+			*token = static_cast<unsigned char>(std::min<std::size_t>(lit, 15) << 4);
+			if (15 <= lit)
+			{
+				op = length(op, lit - 15);
+			}
+			std::memcpy(op, src + anchor, lit);
+			op += lit;
+
+			if (0 < match)
+			{
+				*op++ = static_cast<unsigned char>(offset);
+				*op++ = static_cast<unsigned char>(offset >> 8);
+				const auto n = match - minmatch;
+				*token |= static_cast<unsigned char>(std::min<std::size_t>(n, 15));
+				if (15 <= n)
+				{
+					op = length(op, n - 15);
+				}
+			}
+		};
+
+		if (mflimit < size)
+		{
+			std::fill_n(table, 1 << bits, 0);
+			const auto limit = size - mflimit;
+			const auto end = size - lastliterals;
+			for (std::size_t i = 0; i < limit; )
+			{
+				const auto seq = read32(src + i);
+				auto& slot = table[hash(seq)];
+				std::size_t from = slot;
+				slot = static_cast<std::uint32_t>(i);
+
+				if (from < i and i - from < window and read32(src + from) == seq)
+				{
+					// Take in equal bytes before as well
+					while (anchor < i and 0 < from and src[i - 1] == src[from - 1])
+					{
+						-- i;
+						-- from;
+					}
+					const auto match = minmatch + common(src + i + minmatch, src + from + minmatch, end - i - minmatch);
+					emit(i - from, match, i);
+					i += match;
+					anchor = i;
+				}
+				else
+				{
+					// Step further the longer nothing matches
+					i += 1 + ((i - anchor) >> 6);
+				}
+			}
+		}
+
+		emit(0, 0, size);
+		return static_cast<std::size_t>(op - dst);
+	}
+
+	std::ptrdiff_t unpack(const char* in, std::size_t size, char* base, std::size_t pos, std::size_t end)
+	{
+		auto ip = reinterpret_cast<const unsigned char*>(in);
+		const auto iend = ip + size;
+		auto op = base + pos;
+		const auto oend = base + end;
+		constexpr auto bad = static_cast<std::size_t>(-1);
+
+		const auto length = [&](std::size_t n)
+		{
+			if (15 == n)
+			{
+				unsigned char b;
+				do
+				{
+					if (iend == ip)
+					{
+						return bad;
+					}
+					b = *ip++;
+					n += b;
+				}
+				while (255 == b);
+			}
+			return n;
+		};
+
+		for (;;)
+		{
+			if (iend == ip)
+			{
+				return -1;
+			}
+			const auto token = *ip++;
+
+			const auto lit = length(token >> 4);
+			if (bad == lit or static_cast<std::size_t>(iend - ip) < lit or static_cast<std::size_t>(oend - op) < lit)
+			{
+				return -1;
+			}
+			std::memcpy(op, ip, lit);
+			op += lit;
+			ip += lit;
+
+			// Only the last sequence has no match
+			if (iend == ip)
+			{
+				break;
+			}
+
+			if (iend - ip < 2)
+			{
+				return -1;
+			}
+			const std::size_t offset = ip[0] | ip[1] << 8;
+			ip += 2;
+
+			const auto n = length(token & 15);
+			if (bad == n)
+			{
+				return -1;
+			}
+			const auto match = n + minmatch;
+			if (0 == offset or static_cast<std::size_t>(op - base) < offset or static_cast<std::size_t>(oend - op) < match)
+			{
+				return -1;
+			}
+
+			// Whole words when the source is far enough back, trusting the slack
+			const auto from = op - offset;
+			if (16 <= offset)
+			{
+				for (std::size_t k = 0; k < match; k += 16)
+				{
+					std::memcpy(op + k, from + k, 16);
+				}
+			}
+			else
+			if (8 <= offset)
+			{
+				for (std::size_t k = 0; k < match; k += 8)
+				{
+					std::memcpy(op + k, from + k, 8);
+				}
+			}
+			else
+			{
+				for (std::size_t k = 0; k < match; ++k)
+				{
+					op[k] = from[k];
+				}
+			}
+			op += match;
+		}
+		return op - base;
+	}
+}
+
+namespace fmt
+{
+	lz4buf::lz4buf(base* next, std::size_t size)
+	: next(next), block(window)
+	{
+		while (block < size and block < (1 << 22))
+		{
+			block <<= 2;
+		}
+	}
+
+	lz4buf::~lz4buf()
+	{
+		(void) finish();
+	}
+
+	bool lz4buf::finish()
+	{
+		if (state::put == mode)
+		{
+			mode = state::done;
+			(void) flush(true);
+			if (-1 == next->pubsync())
+			{
+				failed = true;
+			}
+		}
+		return not failed;
+	}
+
+	bool lz4buf::write(const void* data, std::size_t size)
+	{
+		const auto n = static_cast<std::streamsize>(size);
+		if (failed or n != next->sputn(static_cast<const char*>(data), n))
+		{
+			failed = true;
+		}
+		return not failed;
+	}
+
+	bool lz4buf::read(void* data, std::size_t size)
+	{
+		const auto n = static_cast<std::streamsize>(size);
+		if (failed or n != next->sgetn(static_cast<char*>(data), n))
+		{
+			failed = true;
+		}
+		return not failed;
+	}
+
+	bool lz4buf::header()
+	{
+		// Independent blocks with a content checksum
+		unsigned char h[7];
+		le32(h, magic);
+		h[4] = 0x40 | 0x20 | 0x04;
+		h[5] = static_cast<unsigned char>((std::countr_zero(block) - 8) / 2 << 4);
+		h[6] = static_cast<unsigned char>(xxh32::of(h + 4, 2) >> 8);
+		return write(h, sizeof h);
+	}
+
+	bool lz4buf::flush(bool last)
+	{
+		const auto n = static_cast<std::size_t>(pptr() - pbase());
+		if (0 < n)
+		{
+			sum.update(pbase(), n);
+			packed.resize(lz4::bound(block));
+			table.resize(1 << bits);
+			const auto size = lz4::pack(pbase(), n, packed.data(), table.data());
+
+			unsigned char w[4];
+			if (size < n)
+			{
+				le32(w, static_cast<std::uint32_t>(size));
+				(void) (write(w, sizeof w) and write(packed.data(), size));
+			}
+			else
+			{
+				le32(w, static_cast<std::uint32_t>(n) | raw);
+				(void) (write(w, sizeof w) and write(pbase(), n));
+			}
+			setp(buf.data(), buf.data() + block);
+		}
+
+		if (last)
+		{
+			unsigned char w[8];
+			le32(w, 0);
+			le32(w + 4, sum.digest());
+			(void) write(w, sizeof w);
+		}
+		return not failed;
+	}
+
+	lz4buf::int_type lz4buf::overflow(int_type c)
+	{
+		constexpr auto eof = traits_type::eof();
+		if (state::idle == mode)
+		{
+			mode = state::put;
+			buf.resize(block);
+			setp(buf.data(), buf.data() + block);
+			if (not header())
+			{
+				return eof;
+			}
+		}
+		if (state::put != mode or (pptr() == epptr() and not flush(false)))
+		{
+			return eof;
+		}
+		if (not traits_type::eq_int_type(eof, c))
+		{
+			*pptr() = traits_type::to_char_type(c);
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+
+	int lz4buf::sync()
+	{
+		if (state::put == mode)
+		{
+			// Blocks end here so that all written so far can be read back
+			return flush(false) and -1 != next->pubsync() ? 0 : -1;
+		}
+		return failed ? -1 : 0;
+	}
+
+	lz4buf::int_type lz4buf::underflow()
+	{
+		if (gptr() == egptr() and not fill())
+		{
+			return traits_type::eof();
+		}
+		return traits_type::to_int_type(*gptr());
+	}
+
+	bool lz4buf::fill()
+	{
+		unsigned char w[4];
+		auto pos = static_cast<std::size_t>(egptr() - buf.data());
+		while (not failed and state::done != mode and state::put != mode)
+		{
+			if (state::idle == mode)
+			{
+				// Input may end between frames
+				const auto got = next->sgetn(reinterpret_cast<char*>(w), sizeof w);
+				if (0 == got)
+				{
+					mode = state::done;
+					break;
+				}
+				if (sizeof w != got)
+				{
+					failed = true;
+					break;
+				}
+
+				const auto id = le32(w);
+				if (skippable == (id & ~0xFu))
+				{
+					if (not read(w, sizeof w))
+					{
+						break;
+					}
+					for (auto n = le32(w); 0 < n and not failed; )
+					{
+						const auto m = std::min<std::size_t>(n, sizeof w);
+						(void) read(w, m);
+						n -= static_cast<std::uint32_t>(m);
+					}
+					continue;
+				}
+
+				unsigned char d[14];
+				if (magic != id or not read(d, 2) or 1 != d[0] >> 6)
+				{
+					failed = true;
+					break;
+				}
+				std::size_t n = 2;
+				if (0x08 & d[0])
+				{
+					(void) read(d + n, 8); // content size
+					n += 8;
+				}
+				if (0x01 & d[0])
+				{
+					(void) read(d + n, 4); // dictionary id
+					n += 4;
+				}
+				const auto code = (d[1] >> 4) & 7;
+				if (not read(d + n, 1) or code < 4 or d[n] != static_cast<unsigned char>(xxh32::of(d, n) >> 8))
+				{
+					failed = true;
+					break;
+				}
+
+				linked = not (0x20 & d[0]);
+				blocks = 0x10 & d[0];
+				checked = 0x04 & d[0];
+				block = std::size_t(1) << (8 + 2 * code);
+				buf.resize(window + block + slack);
+				packed.resize(block);
+				sum = xxh32();
+				pos = 0;
+				mode = state::get;
+			}
+
+			if (not read(w, sizeof w))
+			{
+				break;
+			}
+
+			const auto word = le32(w);
+			if (0 == word)
+			{
+				// End mark then perhaps another frame
+				if (checked and (not read(w, sizeof w) or le32(w) != sum.digest()))
+				{
+					failed = true;
+					break;
+				}
+				mode = state::idle;
+				continue;
+			}
+
+			const auto size = word & ~raw;
+			if (block < size)
+			{
+				failed = true;
+				break;
+			}
+
+			// Keep the last window of output for matches that reach back
+			if (linked)
+			{
+				const auto keep = std::min(window, pos);
+				std::memmove(buf.data(), buf.data() + pos - keep, keep);
+				pos = keep;
+			}
+			else
+			{
+				pos = 0;
+			}
+
+			const auto at = buf.data() + pos;
+			std::size_t end = pos + size;
+			if (raw & word)
+			{
+				if (not read(at, size) or (blocks and not verify(at, size)))
+				{
+					break;
+				}
+			}
+			else
+			{
+				if (not read(packed.data(), size) or (blocks and not verify(packed.data(), size)))
+				{
+					break;
+				}
+				const auto n = lz4::unpack(packed.data(), size, buf.data(), pos, pos + block);
+				if (n < 0)
+				{
+					failed = true;
+					break;
+				}
+				end = static_cast<std::size_t>(n);
+			}
+
+			if (checked)
+			{
+				sum.update(at, end - pos);
+			}
+			setg(at, at, buf.data() + end);
+			if (pos < end)
+			{
+				return true;
+			}
+		}
+		setg(nullptr, nullptr, nullptr);
+		return false;
+	}
+
+	bool lz4buf::verify(const void* data, std::size_t size)
+	{
+		unsigned char w[4];
+		if (read(w, sizeof w) and le32(w) != xxh32::of(data, size))
+		{
+			failed = true;
+		}
+		return not failed;
+	}
+}
+
+#ifdef TEST
+#include <sstream>
+TEST(lz4)
+{
+	// Reference digests
+	ASSERT(0x02CC5D05 == fmt::xxh32::of("", 0));
+	ASSERT(0x32D153FF == fmt::xxh32::of("abc", 3));
+	{
+		fmt::xxh32 h;
+		const char text[] = "Nobody inspects the spammish repetition";
+		for (std::size_t n = 0; n + 1 < sizeof text; ++n)
+		{
+			h.update(text + n, 1);
+		}
+		ASSERT(h.digest() == fmt::xxh32::of(text, sizeof text - 1));
+	}
+
+	// Text with repeats, runs and some noise over many blocks
+	std::string text;
+	for (int n = 0; text.size() < 300000; ++n)
+	{
+		text += "/usr/share/doc/package-";
+		text += std::to_string(n % 997);
+		text += n % 7 ? "/README\n" : "/changelog.gz\n";
+		text.append(n % 13, 'x');
+		text += static_cast<char>(n * 7919 % 251);
+	}
+
+	std::stringbuf file;
+	{
+		fmt::lz4buf z(&file);
+		std::ostream out(&z);
+		out.write(text.data(), 1000);
+		out.flush(); // a short block
+		out.write(text.data() + 1000, text.size() - 1000);
+		ASSERT(z.finish());
+	}
+	const auto packed = file.str();
+	ASSERT(packed.size() < text.size() / 3);
+
+	{
+		std::stringbuf in(packed);
+		fmt::lz4_istream z(&in);
+		std::string back((std::istreambuf_iterator<char>(z)), std::istreambuf_iterator<char>());
+		ASSERT(back == text);
+		ASSERT(z.intact());
+	}
+
+	// Damage is noticed rather than read as data
+	{
+		auto broken = packed;
+		broken[broken.size() / 2] ^= 0x55;
+		std::stringbuf in(broken);
+		fmt::lz4_istream z(&in);
+		std::string back((std::istreambuf_iterator<char>(z)), std::istreambuf_iterator<char>());
+		ASSERT(not z.intact() or back != text);
+	}
+
+	// Short inputs are stored
+	{
+		char out[64], back[64];
+		fwd::vector<std::uint32_t> table(4096);
+		const auto n = fmt::lz4::pack("tiny", 4, out, table.data());
+		ASSERT(fmt::lz4::unpack(out, n, back, 0, 4) == 4);
+		ASSERT(0 == std::memcmp(back, "tiny", 4));
+	}
+}
+#endif
@@ -0,0 +1,105 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "mem.hpp"
+#include <algorithm>
+
+namespace fmt::scratch
+{
+	void* arena::grow(std::size_t size, std::size_t align)
+	{
+		const auto need = size + align;
+		// Chunks left over from before a rewind are used again
+		while (index + 1 < chunks.size())
+		{
+			++ index;
+			used = 0;
+			if (need <= chunks[index].size)
+			{
+				return allocate(size, align);
+			}
+		}
+
+		constexpr std::size_t first = 1 << 16;
+		const auto last = chunks.empty() ? 0 : chunks.back().size;
+		const auto bytes = std::max({ first, 2 * last, need });
+		chunks.push_back({ std::unique_ptr<char[]>(new char[bytes]), bytes });
+		index = chunks.size() - 1;
+		used = 0;
+		return allocate(size, align);
+	}
+
+	bool arena::owns(const void* ptr) const
+	{
+		const auto at = static_cast<const char*>(ptr);
+		for (const auto& it : chunks)
+		{
+			const auto begin = it.data.get();
+			if (begin <= at and at < begin + it.size)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+#ifdef TEST
+
+TEST(mem)
+{
+	auto& local = fmt::scratch::arena::local();
+	ASSERT(not local.active());
+	// Heap outside of any scope
+	{
+		fmt::scratch::string s(100, 'x');
+		ASSERT(not local.owns(s.data()));
+	}
+	// Arena inside a scope, rewound on exit
+	const char* first = nullptr;
+	{
+		fmt::scratch::scope scope;
+		ASSERT(local.active());
+		fmt::scratch::string s(100, 'x');
+		ASSERT(local.owns(s.data()));
+		first = s.data();
+
+		fmt::scratch::vector v;
+		for (auto u : { "a", "b", "c", "d", "e", "f", "g", "h" })
+		{
+			v.emplace_back(u);
+		}
+		ASSERT(8 == v.size());
+		ASSERT(local.owns(v.data()));
+		ASSERT(v.back() == "h");
+	}
+	ASSERT(not local.active());
+	{
+		fmt::scratch::scope scope;
+		fmt::scratch::string s(100, 'y');
+		ASSERT(s.data() == first);
+	}
+
+	// Made outside a scope stays on the heap as it grows inside one
+	{
+		fmt::scratch::string s;
+		{
+			fmt::scratch::scope scope;
+			s.assign(1000, 'z');
+			ASSERT(not local.owns(s.data()));
+		}
+		s += 'z';
+		ASSERT(1001 == s.size());
+	}
+
+	// A copy takes from where it is made
+	{
+		const fmt::scratch::string s(100, 'x');
+		fmt::scratch::scope scope;
+		const auto t = s;
+		ASSERT(local.owns(t.data()) and t == s);
+	}
+}
+
+#endif
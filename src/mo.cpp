@@ -0,0 +1,247 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "mo.hpp"
+#include "dir.hpp"
+#include "usr.hpp"
+#include <cstring>
+#include <cstdio>
+
+namespace
+{
+	constexpr std::uint32_t magic = 0x950412de;
+	constexpr std::size_t header = 28; // seven words
+
+	std::uint32_t reverse(std::uint32_t w)
+	{
+		return (w >> 24) | ((w >> 8) & 0xff00) | ((w << 8) & 0xff0000) | (w << 24);
+	}
+
+	std::uint32_t hash(fmt::view u)
+	// Same as hash_string in GNU gettext
+	{
+		std::uint32_t h = 0;
+		for (const unsigned char c : u)
+		{
+			h = (h << 4) + c;
+			if (const auto g = h & 0xf0000000; 0 != g)
+			{
+				h ^= g >> 24;
+				h ^= g;
+			}
+		}
+		return h;
+	}
+}
+
+namespace fmt
+{
+	mo::mo(view path)
+	{
+		using namespace env::file;
+		// Quietly accept missing catalogs
+		if (fail(path, rd))
+		{
+			return;
+		}
+
+		const auto f = open(path, rd);
+		if (nullptr == f or std::fseek(f.get(), 0, SEEK_END))
+		{
+			return;
+		}
+
+		const auto end = std::ftell(f.get());
+		if (end < static_cast<long>(header))
+		{
+			return;
+		}
+
+		buf = map(f.get(), rd, 0, end);
+		// Either null or MAP_FAILED when it did not work
+		const auto data = reinterpret_cast<std::intptr_t>(buf.get());
+		if (0 == data or -1 == data)
+		{
+			return;
+		}
+		size = end;
+
+		if (magic != at(0))
+		{
+			swap = true;
+			if (magic != at(0))
+			{
+				size = 0;
+				return;
+			}
+		}
+
+		count = at(8);
+		orig = at(12);
+		trans = at(16);
+		slots = at(20);
+		table = at(24);
+
+		// Tables must lie inside the file
+		const auto n = std::uint64_t(count) * 8;
+		const auto k = std::uint64_t(slots) * 4;
+		if (size < orig + n or size < trans + n or size < table + k)
+		{
+			size = 0;
+		}
+	}
+
+	mo::operator bool() const
+	{
+		return 0 < size;
+	}
+
+	mo::word mo::at(std::size_t off) const
+	{
+		word w = 0;
+		if (off + sizeof w <= size)
+		{
+			std::memcpy(&w, buf.get() + off, sizeof w);
+		}
+		return swap ? reverse(w) : w;
+	}
+
+	view mo::entry(word index, word n) const
+	{
+		const std::size_t off = index + std::size_t(n) * 8;
+		const auto len = at(off);
+		const auto pos = at(off + 4);
+		if (size < pos or size - pos < len)
+		{
+			return { };
+		}
+		// Plural forms follow the first NUL
+		const view u(buf.get() + pos, len);
+		return u.substr(0, u.find('\0'));
+	}
+
+	view mo::find(view u) const
+	{
+		if (not *this)
+		{
+			return { };
+		}
+
+		if (2 < slots)
+		{
+			const auto h = hash(u);
+			const auto step = 1 + h % (slots - 2);
+			auto idx = h % slots;
+			// Bounded in case of a corrupt table
+			for (word tries = 0; tries < slots; ++tries)
+			{
+				const auto k = at(table + std::size_t(idx) * 4);
+				if (0 == k)
+				{
+					break;
+				}
+				if (k <= count and entry(orig, k - 1) == u)
+				{
+					return entry(trans, k - 1);
+				}
+				idx = slots - step <= idx ? idx - (slots - step) : idx + step;
+			}
+			return { };
+		}
+
+		// Originals are sorted when there is no hash table
+		word lo = 0, hi = count;
+		while (lo < hi)
+		{
+			const auto mid = lo + (hi - lo) / 2;
+			const auto cmp = entry(orig, mid).compare(u);
+			if (0 == cmp)
+			{
+				return entry(trans, mid);
+			}
+			else
+			if (cmp < 0)
+			{
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+		return { };
+	}
+
+	string mo::path(view domain, const std::locale& loc)
+	{
+		const auto name = loc.name();
+		if (name.empty() or "C" == name or "POSIX" == name or "*" == name)
+		{
+			return { };
+		}
+
+		string file;
+		auto probe = [&](view dir, view lang)
+		{
+			(void) fmt::dir::join_to(file, { dir, "locale", lang, "LC_MESSAGES", domain });
+			file += ".mo";
+			return not env::file::fail(file, env::file::rd);
+		};
+
+		auto test = [&](view dir)
+		{
+			view lang = name;
+			if (probe(dir, lang))
+			{
+				return true;
+			}
+			// Drop the modifier, codeset then territory in turn
+			for (const char c : { '@', '.', '_' })
+			{
+				if (const auto pos = lang.find(c); npos != pos)
+				{
+					lang = lang.substr(0, pos);
+					if (probe(dir, lang))
+					{
+						return true;
+					}
+				}
+			}
+			return false;
+		};
+
+		if (test(env::usr::data_home()))
+		{
+			return file;
+		}
+		for (const auto dir : env::usr::data_dirs())
+		{
+			if (test(dir))
+			{
+				return file;
+			}
+		}
+		return { };
+	}
+}
+
+#ifdef TEST
+
+TEST(mo)
+{
+	const auto path = fmt::mo::path("sed", std::locale("de_DE.utf8"));
+	if (not path.empty())
+	{
+		const fmt::mo cat(path);
+		ASSERT(cat);
+		ASSERT(cat.find("No match") == "Keine Übereinstimmung");
+		ASSERT(cat.find("Memory exhausted") == "Speicher erschöpft");
+		ASSERT(cat.find("No such message in the catalog").empty());
+	}
+	const fmt::mo none("/no/such/catalog.mo");
+	ASSERT(not none);
+	ASSERT(none.find("No match").empty());
+}
+
+#endif
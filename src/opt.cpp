@@ -11,6 +11,8 @@
 #include "dir.hpp"
 #include "type.hpp"
 #include "sync.hpp"
+#include "mem.hpp"
+#include "build.hpp"
 #include <fstream>
 
 namespace
@@ -36,10 +38,9 @@ namespace
 		const auto u = env::opt::get(key);
 		if (not u.empty())
 		{
-			const auto s = fmt::to_lower(u);
 			for (const auto v : check)
 			{
-				if (s.starts_with(v))
+				if (fmt::istarts_with(u, v))
 				{
 					return false;
 				}
@@ -66,7 +67,7 @@ namespace fmt::opt
 
 	string join(pair param, pair style)
 	{
-		buffer buf;
+		builder buf;
 		auto key = trim(param.first, tag::quote);
 		auto value = trim(param.second, tag::quote);
 		buf << style.first << key;
@@ -79,7 +80,7 @@ namespace fmt::opt
 			}
 			else buf << value;
 		}
-		return buf.str();
+		return buf.get();
 	}
 }
 
@@ -107,6 +108,17 @@ namespace env::opt
 		return set(key, u);
 	}
 
+	bool get(fmt::atoms key, bool value)
+	{
+		return cast(key, value);
+	}
+
+	bool set(fmt::atoms key, bool value)
+	{
+		fmt::view u = cast(value);
+		return set(key, u);
+	}
+
 	fmt::view get(fmt::view key, fmt::view value)
 	{
 		return got(key) ? get(key) : value;
@@ -117,6 +129,11 @@ namespace env::opt
 		return got(key) ? get(key) : value;
 	}
 
+	fmt::view get(fmt::atoms key, fmt::view value)
+	{
+		return got(key) ? get(key) : value;
+	}
+
 	long get(fmt::view key, long value, int base)
 	{
 		return cast(key, value, [base](auto value)
@@ -164,9 +181,35 @@ namespace env::opt
 		});
 	}
 
-	bool set(fmt::pair key, float value)
+	bool set(fmt::pair key, float value, int digits)
+	{
+		return set(key, fmt::to_string(value, digits));
+	}
+
+	long get(fmt::atoms key, long value, int base)
+	{
+		return cast(key, value, [base](auto value)
+		{
+			return fmt::to_long(value, base);
+		});
+	}
+
+	bool set(fmt::atoms key, long value, int base)
+	{
+		return set(key, fmt::to_string(value, base));
+	}
+
+	float get(fmt::atoms key, float value)
+	{
+		return cast(key, value, [](auto value)
+		{
+			return fmt::to_float(value);
+		});
+	}
+
+	bool set(fmt::atoms key, float value, int digits)
 	{
-		return set(key, fmt::to_string(value));
+		return set(key, fmt::to_string(value, digits));
 	}
 }
 
@@ -269,9 +312,11 @@ namespace env::opt
 			assert(not args.empty());
 			auto const path = args.front();
 			assert(not path.empty());
-			auto const dirs = fmt::dir::split(path);
-			assert(not dirs.empty());
-			auto const name = dirs.back();
+			fmt::view name;
+			for (auto const part : fmt::dir::tokenize(path))
+			{
+				name = part;
+			}
 			assert(not name.empty());
 			auto const first = name.find_first_not_of("./");
 			auto const last = name.rfind(sys::tag::image);
@@ -337,6 +382,21 @@ namespace env::opt
 		return registry().writer()->set(key, value);
 	}
 
+	bool got(fmt::atoms key)
+	{
+		return registry().reader()->got(key);
+	}
+
+	fmt::view get(fmt::atoms key)
+	{
+		return registry().reader()->get(key);
+	}
+
+	bool set(fmt::atoms key, fmt::view value)
+	{
+		return registry().writer()->set(key, value);
+	}
+
 	bool got(fmt::view key)
 	{
 		return not get(key).empty();
@@ -378,7 +438,11 @@ namespace env::opt
 		// Push a view to command line arguments
 		std::copy(argv, argv + argc, std::back_inserter(list));
 		// Arguments not part of a command
-		fmt::vector extra, args;
+		fmt::vector extra;
+		// Values of the current command are scratch
+		fmt::scratch::scope scope;
+		fmt::scratch::vector args;
+		fmt::scratch::string value;
 		// Command line range
 		const auto end = cmd.end();
 		auto current = end;
@@ -403,9 +467,11 @@ namespace env::opt
 				{
 					// Set as option
 					args.emplace_back(argu);
-					const auto value = fmt::join(args, ";");
+					value.clear();
+					value.reserve(fmt::join_size(args, ";"));
+					fmt::join_to(std::back_inserter(value), args, ";");
 					const auto key = fmt::tag::emplace(current->name);
-					(void) set(key, value);
+					(void) set(key, fmt::view(value.data(), value.size()));
 				}
 				else
 				{
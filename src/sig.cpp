@@ -5,15 +5,14 @@
 #include "sig.hpp"
 #include "fmt.hpp"
 #include "sync.hpp"
-#include <unordered_map>
 #include <functional>
 #include <csignal>
 
 namespace
 {
-	static sys::exclusive<std::unordered_map<std::string_view, fwd::event>> sigmap;
-	static sys::exclusive<std::unordered_map<int, fwd::event>> sighandler;
-	static const std::unordered_map<std::string_view, int> sigint
+	static sys::exclusive<fwd::hash_map<fmt::atom, fwd::event>> sigmap;
+	static sys::exclusive<fwd::hash_map<int, fwd::event>> sighandler;
+	constexpr fwd::pair<std::string_view, int> signals[] =
 	{
 		#ifdef SIGABRT
 		{ "abort", SIGABRT },
@@ -119,6 +118,9 @@ namespace
 		{ "size", SIGXFSZ },
 		#endif
 	};
+
+	constexpr fwd::static_map sigint(signals);
+	static_assert(sigint.unique());
 	
 	static void handler(int no)
 	{
@@ -155,16 +157,22 @@ namespace sys::sig
 			}
 		}
 		auto writer = sigmap.writer();
-		writer->emplace(key, value);
+		writer->emplace(fmt::tag::intern(key), value);
 	}
 	
 	fwd::event get(fmt::view key)
 	{
+		const auto id = fmt::tag::find(key);
+		if (fmt::atom() == id and not key.empty())
+		{
+			// Never set so nothing to intern
+			return fwd::event();
+		}
 		auto reader = sigmap.reader();
-		if (auto it = reader->find(key); reader->end() != it)
+		if (auto it = reader->find(id); reader->end() != it)
 		{
 			#ifdef assert
-			assert(key == it->first);
+			assert(id == it->first);
 			#endif
 			return it->second;
 		}
@@ -0,0 +1,1230 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "simd.hpp"
+#include <string_view>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+#include <array>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+# define SIMD_X86
+# include <immintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+#  define TARGET(x)
+# else
+#  define TARGET(x) __attribute__((target(x)))
+# endif
+#endif
+
+namespace
+{
+	using fmt::simd::size_t;
+
+	inline size_t low_bit(unsigned bits)
+	{
+		return static_cast<size_t>(std::countr_zero(bits));
+	}
+
+	namespace scalar
+	{
+		struct table
+		{
+			bool has[256] = { };
+
+			table(const char* t, size_t m)
+			{
+				for (size_t j = 0; j < m; ++j)
+				{
+					has[static_cast<unsigned char>(t[j])] = true;
+				}
+			}
+
+			bool operator()(char c) const
+			{
+				return has[static_cast<unsigned char>(c)];
+			}
+		};
+
+		size_t find(const char* s, size_t n, char c)
+		{
+			const auto p = std::memchr(s, c, n);
+			return nullptr == p ? n : static_cast<const char*>(p) - s;
+		}
+
+		size_t find(const char* s, size_t n, const char* t, size_t m)
+		{
+			const auto i = std::string_view(s, n).find(std::string_view(t, m));
+			return std::string_view::npos == i ? n : i;
+		}
+
+		size_t find_of(const char* s, size_t n, const char* t, size_t m)
+		{
+			const table in(t, m);
+			return std::find_if(s, s + n, std::cref(in)) - s;
+		}
+
+		size_t find_not_of(const char* s, size_t n, const char* t, size_t m)
+		{
+			const table in(t, m);
+			return std::find_if_not(s, s + n, std::cref(in)) - s;
+		}
+
+		size_t count(const char* s, size_t n, char c)
+		{
+			return static_cast<size_t>(std::count(s, s + n, c));
+		}
+
+		size_t find_in(const char* s, size_t n, const fmt::simd::charset& t)
+		{
+			const auto u = reinterpret_cast<const unsigned char*>(s);
+			size_t i = 0;
+			while (i < n and not t.contains(u[i]))
+			{
+				++ i;
+			}
+			return i;
+		}
+
+		size_t find_not_in(const char* s, size_t n, const fmt::simd::charset& t)
+		{
+			const auto u = reinterpret_cast<const unsigned char*>(s);
+			size_t i = 0;
+			while (i < n and t.contains(u[i]))
+			{
+				++ i;
+			}
+			return i;
+		}
+
+		void classify(const char* s, size_t n, const fmt::simd::charset& t, std::uint64_t* out)
+		{
+			const auto u = reinterpret_cast<const unsigned char*>(s);
+			for (size_t i = 0; i < n; i += 64)
+			{
+				std::uint64_t w = 0;
+				const auto m = std::min<size_t>(64, n - i);
+				for (size_t j = 0; j < m; ++j)
+				{
+					w |= std::uint64_t(t.contains(u[i + j])) << j;
+				}
+				*out++ = w;
+			}
+		}
+
+		size_t ascii(const char* s, size_t n)
+		{
+			return std::find_if(s, s + n, [](char c) { return c & 0x80; }) - s;
+		}
+
+		template <class Skip> size_t validate(const char* s, size_t n, Skip skip)
+		// Well formed sequences as in table 3-7 of the Unicode standard
+		{
+			const auto u = reinterpret_cast<const unsigned char*>(s);
+			for (size_t i = 0; i < n;)
+			{
+				const unsigned b = u[i];
+				if (b < 0x80)
+				{
+					i += skip(s + i, n - i);
+					continue;
+				}
+				if (b < 0xC2 or 0xF4 < b)
+				{
+					return i;
+				}
+				// Range of the second byte narrows for some leads
+				unsigned lo = 0x80, hi = 0xBF;
+				switch (b)
+				{
+				case 0xE0: lo = 0xA0; break;
+				case 0xED: hi = 0x9F; break;
+				case 0xF0: lo = 0x90; break;
+				case 0xF4: hi = 0x8F; break;
+				}
+				const size_t m = b < 0xE0 ? 2 : b < 0xF0 ? 3 : 4;
+				if (n - i < m or u[i + 1] < lo or hi < u[i + 1])
+				{
+					return i;
+				}
+				for (size_t j = 2; j < m; ++j)
+				{
+					if (0x80 != (u[i + j] & 0xC0))
+					{
+						return i;
+					}
+				}
+				i += m;
+			}
+			return n;
+		}
+
+		size_t invalid(const char* s, size_t n)
+		{
+			return validate(s, n, ascii);
+		}
+
+		size_t runes(const char* s, size_t n)
+		{
+			return static_cast<size_t>(std::count_if(s, s + n, [](char c) { return 0x80 != (c & 0xC0); }));
+		}
+
+		inline char fold(char c)
+		{
+			return 'A' <= c and c <= 'Z' ? c | 0x20 : c;
+		}
+
+		size_t iequal(const char* s, const char* t, size_t n)
+		{
+			size_t i = 0;
+			while (i < n and fold(s[i]) == fold(t[i]))
+			{
+				++ i;
+			}
+			return i;
+		}
+
+		size_t ifind(const char* s, size_t n, const char* t, size_t m)
+		{
+			for (size_t i = 0; i + m <= n; ++i)
+			{
+				if (m == iequal(s + i, t, m))
+				{
+					return i;
+				}
+			}
+			return n;
+		}
+
+		size_t restart(const char* s, size_t i)
+		// Start of the sequence which may span offset $i in $s
+		{
+			auto j = i;
+			while (0 < j and i - j < 3 and 0x80 == (s[j - 1] & 0xC0))
+			{
+				-- j;
+			}
+			return 0 < j and i - j < 3 and 0xC0 == (s[j - 1] & 0xC0) ? j - 1 : i;
+		}
+
+		constexpr auto crc_table = []
+		{
+			// Reflected Castagnoli polynomial, then a table per byte of a word
+			std::array<std::array<std::uint32_t, 256>, 8> t { };
+			for (std::uint32_t n = 0; n < 256; ++n)
+			{
+				auto c = n;
+				for (int k = 0; k < 8; ++k)
+				{
+					c = c >> 1 ^ (c & 1 ? 0x82F63B78 : 0);
+				}
+				t[0][n] = c;
+			}
+			for (std::uint32_t n = 0; n < 256; ++n)
+			{
+				for (int k = 1; k < 8; ++k)
+				{
+					t[k][n] = t[k - 1][n] >> 8 ^ t[0][t[k - 1][n] & 0xFF];
+				}
+			}
+			return t;
+		}();
+
+		std::uint32_t crc32c(std::uint32_t crc, const char* s, size_t n)
+		{
+			const auto& t = crc_table;
+			auto p = reinterpret_cast<const unsigned char*>(s);
+			auto c = ~crc;
+			// Slicing by eight bytes at a time
+			for (; 8 <= n; p += 8, n -= 8)
+			{
+				const auto lo = c ^ (p[0] | p[1] << 8 | p[2] << 16 | std::uint32_t(p[3]) << 24);
+				c = t[7][lo & 0xFF] ^ t[6][lo >> 8 & 0xFF] ^ t[5][lo >> 16 & 0xFF] ^ t[4][lo >> 24]
+				  ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+			}
+			for (; 0 < n; ++p, --n)
+			{
+				c = c >> 8 ^ t[0][(c ^ *p) & 0xFF];
+			}
+			return ~c;
+		}
+	}
+
+	#ifdef SIMD_X86
+
+	namespace sse2
+	{
+		using vec = __m128i;
+		constexpr size_t width = sizeof(vec);
+
+		TARGET("sse2") inline vec load(const char* s)
+		{
+			return _mm_loadu_si128(reinterpret_cast<const vec*>(s));
+		}
+
+		TARGET("sse2") inline unsigned bits(vec x)
+		{
+			return static_cast<unsigned>(_mm_movemask_epi8(x));
+		}
+
+		TARGET("sse2") size_t find(const char* s, size_t n, char c)
+		{
+			const auto v = _mm_set1_epi8(c);
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = bits(_mm_cmpeq_epi8(load(s + i), v)))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + scalar::find(s + i, n - i, c);
+		}
+
+		TARGET("sse2") size_t find(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (m < 2 or n < m)
+			{
+				return m ? (m < n + 1 ? find(s, n, *t) : n) : 0;
+			}
+			// Filter candidates on first and last bytes of the needle
+			const auto f = _mm_set1_epi8(t[0]);
+			const auto l = _mm_set1_epi8(t[m - 1]);
+			size_t i = 0;
+			for (; i + m - 1 + width <= n; i += width)
+			{
+				const auto x = _mm_cmpeq_epi8(load(s + i), f);
+				const auto y = _mm_cmpeq_epi8(load(s + i + m - 1), l);
+				for (auto b = bits(_mm_and_si128(x, y)); b; b &= b - 1)
+				{
+					const auto k = i + low_bit(b);
+					if (0 == std::memcmp(s + k + 1, t + 1, m - 2))
+					{
+						return k;
+					}
+				}
+			}
+			return i + scalar::find(s + i, n - i, t, m);
+		}
+
+		TARGET("sse2") inline vec member(vec x, const vec* v, size_t m)
+		{
+			auto y = _mm_cmpeq_epi8(x, v[0]);
+			for (size_t j = 1; j < m; ++j)
+			{
+				y = _mm_or_si128(y, _mm_cmpeq_epi8(x, v[j]));
+			}
+			return y;
+		}
+
+		TARGET("sse2") size_t find_of(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (0 == m)
+			{
+				return n;
+			}
+			vec v[fmt::simd::set_max];
+			for (size_t j = 0; j < m; ++j)
+			{
+				v[j] = _mm_set1_epi8(t[j]);
+			}
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = bits(member(load(s + i), v, m)))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + scalar::find_of(s + i, n - i, t, m);
+		}
+
+		TARGET("sse2") size_t find_not_of(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (0 == m)
+			{
+				return 0;
+			}
+			vec v[fmt::simd::set_max];
+			for (size_t j = 0; j < m; ++j)
+			{
+				v[j] = _mm_set1_epi8(t[j]);
+			}
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = ~bits(member(load(s + i), v, m)) & 0xFFFFu)
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + scalar::find_not_of(s + i, n - i, t, m);
+		}
+
+		TARGET("sse2") size_t count(const char* s, size_t n, char c)
+		{
+			const auto v = _mm_set1_epi8(c);
+			const auto z = _mm_setzero_si128();
+			size_t i = 0, k = 0;
+			while (i + width <= n)
+			{
+				// Byte counters saturate after 255 rounds
+				auto acc = z;
+				for (int r = 0; r < 255 and i + width <= n; ++r, i += width)
+				{
+					acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(load(s + i), v));
+				}
+				alignas(width) std::uint64_t sum[2];
+				_mm_store_si128(reinterpret_cast<vec*>(sum), _mm_sad_epu8(acc, z));
+				k += sum[0] + sum[1];
+			}
+			return k + scalar::count(s + i, n - i, c);
+		}
+
+		TARGET("sse2") size_t ascii(const char* s, size_t n)
+		{
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = bits(load(s + i)))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + scalar::ascii(s + i, n - i);
+		}
+
+		TARGET("sse2") size_t invalid(const char* s, size_t n)
+		{
+			return scalar::validate(s, n, ascii);
+		}
+
+		TARGET("sse2") size_t runes(const char* s, size_t n)
+		{
+			const auto v = _mm_set1_epi8(-65);
+			const auto z = _mm_setzero_si128();
+			size_t i = 0, k = 0;
+			while (i + width <= n)
+			{
+				// Bytes above 10111111 as signed are not continuations
+				auto acc = z;
+				for (int r = 0; r < 255 and i + width <= n; ++r, i += width)
+				{
+					acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(load(s + i), v));
+				}
+				alignas(width) std::uint64_t sum[2];
+				_mm_store_si128(reinterpret_cast<vec*>(sum), _mm_sad_epu8(acc, z));
+				k += sum[0] + sum[1];
+			}
+			return k + scalar::runes(s + i, n - i);
+		}
+
+		TARGET("sse2") inline vec fold(vec x)
+		// Set the case bit of upper case ASCII letters only
+		{
+			const auto up = _mm_cmplt_epi8(_mm_add_epi8(x, _mm_set1_epi8(0x3F)), _mm_set1_epi8(-128 + 26));
+			return _mm_or_si128(x, _mm_and_si128(up, _mm_set1_epi8(0x20)));
+		}
+
+		TARGET("sse2") size_t iequal(const char* s, const char* t, size_t n)
+		{
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				const auto x = _mm_cmpeq_epi8(fold(load(s + i)), fold(load(t + i)));
+				if (const auto b = ~bits(x) & 0xFFFFu)
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + scalar::iequal(s + i, t + i, n - i);
+		}
+
+		TARGET("sse2") size_t ifind(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (0 == m or n < m)
+			{
+				return m ? n : 0;
+			}
+			// Filter candidates on first and last bytes of the needle
+			const auto f = _mm_set1_epi8(scalar::fold(t[0]));
+			const auto l = _mm_set1_epi8(scalar::fold(t[m - 1]));
+			size_t i = 0;
+			for (; i + m - 1 + width <= n; i += width)
+			{
+				const auto x = _mm_cmpeq_epi8(fold(load(s + i)), f);
+				const auto y = _mm_cmpeq_epi8(fold(load(s + i + m - 1)), l);
+				for (auto b = bits(_mm_and_si128(x, y)); b; b &= b - 1)
+				{
+					const auto k = i + low_bit(b);
+					if (m < 3 or m - 2 == iequal(s + k + 1, t + 1, m - 2))
+					{
+						return k;
+					}
+				}
+			}
+			return i + scalar::ifind(s + i, n - i, t, m);
+		}
+	}
+
+	namespace avx2
+	{
+		using vec = __m256i;
+		constexpr size_t width = sizeof(vec);
+
+		TARGET("avx2") inline vec load(const char* s)
+		{
+			return _mm256_loadu_si256(reinterpret_cast<const vec*>(s));
+		}
+
+		TARGET("avx2") inline unsigned bits(vec x)
+		{
+			return static_cast<unsigned>(_mm256_movemask_epi8(x));
+		}
+
+		TARGET("avx2") size_t find(const char* s, size_t n, char c)
+		{
+			const auto v = _mm256_set1_epi8(c);
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = bits(_mm256_cmpeq_epi8(load(s + i), v)))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + sse2::find(s + i, n - i, c);
+		}
+
+		TARGET("avx2") size_t find(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (m < 2 or n < m)
+			{
+				return m ? (m < n + 1 ? find(s, n, *t) : n) : 0;
+			}
+			// Filter candidates on first and last bytes of the needle
+			const auto f = _mm256_set1_epi8(t[0]);
+			const auto l = _mm256_set1_epi8(t[m - 1]);
+			size_t i = 0;
+			for (; i + m - 1 + width <= n; i += width)
+			{
+				const auto x = _mm256_cmpeq_epi8(load(s + i), f);
+				const auto y = _mm256_cmpeq_epi8(load(s + i + m - 1), l);
+				for (auto b = bits(_mm256_and_si256(x, y)); b; b &= b - 1)
+				{
+					const auto k = i + low_bit(b);
+					if (0 == std::memcmp(s + k + 1, t + 1, m - 2))
+					{
+						return k;
+					}
+				}
+			}
+			return i + sse2::find(s + i, n - i, t, m);
+		}
+
+		TARGET("avx2") inline vec member(vec x, const vec* v, size_t m)
+		{
+			auto y = _mm256_cmpeq_epi8(x, v[0]);
+			for (size_t j = 1; j < m; ++j)
+			{
+				y = _mm256_or_si256(y, _mm256_cmpeq_epi8(x, v[j]));
+			}
+			return y;
+		}
+
+		TARGET("avx2") size_t find_of(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (0 == m)
+			{
+				return n;
+			}
+			vec v[fmt::simd::set_max];
+			for (size_t j = 0; j < m; ++j)
+			{
+				v[j] = _mm256_set1_epi8(t[j]);
+			}
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = bits(member(load(s + i), v, m)))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + sse2::find_of(s + i, n - i, t, m);
+		}
+
+		TARGET("avx2") size_t find_not_of(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (0 == m)
+			{
+				return 0;
+			}
+			vec v[fmt::simd::set_max];
+			for (size_t j = 0; j < m; ++j)
+			{
+				v[j] = _mm256_set1_epi8(t[j]);
+			}
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = ~bits(member(load(s + i), v, m)))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + sse2::find_not_of(s + i, n - i, t, m);
+		}
+
+		TARGET("avx2") size_t count(const char* s, size_t n, char c)
+		{
+			const auto v = _mm256_set1_epi8(c);
+			const auto z = _mm256_setzero_si256();
+			size_t i = 0, k = 0;
+			while (i + width <= n)
+			{
+				// Byte counters saturate after 255 rounds
+				auto acc = z;
+				for (int r = 0; r < 255 and i + width <= n; ++r, i += width)
+				{
+					acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(load(s + i), v));
+				}
+				alignas(width) std::uint64_t sum[4];
+				_mm256_store_si256(reinterpret_cast<vec*>(sum), _mm256_sad_epu8(acc, z));
+				k += sum[0] + sum[1] + sum[2] + sum[3];
+			}
+			return k + sse2::count(s + i, n - i, c);
+		}
+
+		TARGET("avx2") size_t ascii(const char* s, size_t n)
+		{
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = bits(load(s + i)))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + sse2::ascii(s + i, n - i);
+		}
+
+		TARGET("avx2") inline vec table(const unsigned char* t)
+		{
+			return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t)));
+		}
+
+		TARGET("avx2") inline vec high(vec x)
+		{
+			return _mm256_and_si256(_mm256_srli_epi16(x, 4), _mm256_set1_epi8(0x0F));
+		}
+
+		template <int N> TARGET("avx2") inline vec prior(vec x, vec p)
+		{
+			return _mm256_alignr_epi8(x, _mm256_permute2x128_si256(p, x, 0x21), 16 - N);
+		}
+
+		TARGET("avx2") vec special(vec x, vec p)
+		// Errors in byte pairs by lookup of their nibbles (Keiser & Lemire)
+		{
+			constexpr unsigned char
+				short_ = 1 << 0, // 11______ 0_______ or 11______ 11______
+				long_ = 1 << 1, // 0_______ 10______
+				over3 = 1 << 2, // 11100000 100_____
+				large = 1 << 3, // 11110100 1001____ and above
+				surr = 1 << 4, // 11101101 101_____
+				over2 = 1 << 5, // 1100000_ 10______
+				large1000 = 1 << 6, // 11110101 1000____ and above
+				over4 = 1 << 6, // 11110000 1000____
+				conts = 1 << 7, // 10______ 10______
+				carry = short_ | long_ | conts;
+
+			static constexpr unsigned char byte_1_high[16]
+			{
+				long_, long_, long_, long_, long_, long_, long_, long_,
+				conts, conts, conts, conts,
+				short_ | over2,
+				short_,
+				short_ | over3 | surr,
+				short_ | large | large1000 | over4,
+			};
+			static constexpr unsigned char byte_1_low[16]
+			{
+				carry | over3 | over2 | over4,
+				carry | over2,
+				carry,
+				carry,
+				carry | large,
+				carry | large | large1000,
+				carry | large | large1000,
+				carry | large | large1000,
+				carry | large | large1000,
+				carry | large | large1000,
+				carry | large | large1000,
+				carry | large | large1000,
+				carry | large | large1000,
+				carry | large | large1000 | surr,
+				carry | large | large1000,
+				carry | large | large1000,
+			};
+			static constexpr unsigned char byte_2_high[16]
+			{
+				short_, short_, short_, short_, short_, short_, short_, short_,
+				long_ | over2 | conts | over3 | large1000 | over4,
+				long_ | over2 | conts | over3 | large,
+				long_ | over2 | conts | surr | large,
+				long_ | over2 | conts | surr | large,
+				short_, short_, short_, short_,
+			};
+
+			const auto a = _mm256_shuffle_epi8(table(byte_1_high), high(p));
+			const auto b = _mm256_shuffle_epi8(table(byte_1_low), _mm256_and_si256(p, _mm256_set1_epi8(0x0F)));
+			const auto c = _mm256_shuffle_epi8(table(byte_2_high), high(x));
+			return _mm256_and_si256(_mm256_and_si256(a, b), c);
+		}
+
+		TARGET("avx2") size_t invalid(const char* s, size_t n)
+		{
+			const auto z = _mm256_setzero_si256();
+			// Leads in the last three bytes which need more bytes
+			const auto max = _mm256_setr_epi8
+			(
+				-1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1,
+				static_cast<char>(0xF0 - 1),
+				static_cast<char>(0xE0 - 1),
+				static_cast<char>(0xC0 - 1)
+			);
+			auto prev = z, error = z, incomplete = z;
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				const auto x = load(s + i);
+				if (0 == bits(x))
+				{
+					error = _mm256_or_si256(error, incomplete);
+				}
+				else
+				{
+					// Third and fourth bytes must be continuations
+					const auto third = _mm256_subs_epu8(prior<2>(x, prev), _mm256_set1_epi8(0xE0 - 0x80));
+					const auto fourth = _mm256_subs_epu8(prior<3>(x, prev), _mm256_set1_epi8(0xF0 - 0x80));
+					const auto must = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(-0x80));
+					const auto pairs = special(x, prior<1>(x, prev));
+					error = _mm256_or_si256(error, _mm256_xor_si256(must, pairs));
+					incomplete = _mm256_subs_epu8(x, max);
+				}
+				if (not _mm256_testz_si256(error, error))
+				{
+					break;
+				}
+				prev = x;
+			}
+			// Find the exact position or check the tail in bytes
+			const auto j = scalar::restart(s, i);
+			return j + scalar::validate(s + j, n - j, sse2::ascii);
+		}
+
+		TARGET("avx2") size_t runes(const char* s, size_t n)
+		{
+			const auto v = _mm256_set1_epi8(-65);
+			const auto z = _mm256_setzero_si256();
+			size_t i = 0, k = 0;
+			while (i + width <= n)
+			{
+				// Bytes above 10111111 as signed are not continuations
+				auto acc = z;
+				for (int r = 0; r < 255 and i + width <= n; ++r, i += width)
+				{
+					acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(load(s + i), v));
+				}
+				alignas(width) std::uint64_t sum[4];
+				_mm256_store_si256(reinterpret_cast<vec*>(sum), _mm256_sad_epu8(acc, z));
+				k += sum[0] + sum[1] + sum[2] + sum[3];
+			}
+			return k + sse2::runes(s + i, n - i);
+		}
+
+		struct lookup
+		// Nibble tables for a charset in vector registers
+		{
+			vec lower, upper, bit;
+
+			TARGET("avx2") lookup(const fmt::simd::charset& t)
+			{
+				static constexpr unsigned char bits[16]
+				{
+					1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128
+				};
+				lower = table(t.row[0]);
+				upper = table(t.row[1]);
+				bit = table(bits);
+			}
+
+			TARGET("avx2") vec operator()(vec x) const
+			{
+				// Pick the row by the high bit and the column by the high nibble
+				const auto lo = _mm256_and_si256(x, _mm256_set1_epi8(0x0F));
+				const auto a = _mm256_shuffle_epi8(lower, lo);
+				const auto b = _mm256_shuffle_epi8(upper, lo);
+				const auto row = _mm256_blendv_epi8(a, b, x);
+				const auto col = _mm256_shuffle_epi8(bit, high(x));
+				return _mm256_cmpeq_epi8(_mm256_and_si256(row, col), col);
+			}
+		};
+
+		TARGET("avx2") size_t find_in(const char* s, size_t n, const fmt::simd::charset& t)
+		{
+			const lookup in(t);
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = bits(in(load(s + i))))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + scalar::find_in(s + i, n - i, t);
+		}
+
+		TARGET("avx2") size_t find_not_in(const char* s, size_t n, const fmt::simd::charset& t)
+		{
+			const lookup in(t);
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				if (const auto b = ~bits(in(load(s + i))))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + scalar::find_not_in(s + i, n - i, t);
+		}
+
+		TARGET("avx2") void classify(const char* s, size_t n, const fmt::simd::charset& t, std::uint64_t* out)
+		{
+			const lookup in(t);
+			size_t i = 0;
+			for (; i + 2 * width <= n; i += 2 * width)
+			{
+				const std::uint64_t lo = bits(in(load(s + i)));
+				const std::uint64_t hi = bits(in(load(s + i + width)));
+				*out++ = lo | hi << 32;
+			}
+			scalar::classify(s + i, n - i, t, out);
+		}
+
+		TARGET("avx2") inline vec fold(vec x)
+		// Set the case bit of upper case ASCII letters only
+		{
+			const auto up = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), _mm256_add_epi8(x, _mm256_set1_epi8(0x3F)));
+			return _mm256_or_si256(x, _mm256_and_si256(up, _mm256_set1_epi8(0x20)));
+		}
+
+		TARGET("avx2") size_t iequal(const char* s, const char* t, size_t n)
+		{
+			size_t i = 0;
+			for (; i + width <= n; i += width)
+			{
+				const auto x = _mm256_cmpeq_epi8(fold(load(s + i)), fold(load(t + i)));
+				if (const auto b = ~bits(x))
+				{
+					return i + low_bit(b);
+				}
+			}
+			return i + sse2::iequal(s + i, t + i, n - i);
+		}
+
+		TARGET("avx2") size_t ifind(const char* s, size_t n, const char* t, size_t m)
+		{
+			if (0 == m or n < m)
+			{
+				return m ? n : 0;
+			}
+			// Filter candidates on first and last bytes of the needle
+			const auto f = _mm256_set1_epi8(scalar::fold(t[0]));
+			const auto l = _mm256_set1_epi8(scalar::fold(t[m - 1]));
+			size_t i = 0;
+			for (; i + m - 1 + width <= n; i += width)
+			{
+				const auto x = _mm256_cmpeq_epi8(fold(load(s + i)), f);
+				const auto y = _mm256_cmpeq_epi8(fold(load(s + i + m - 1)), l);
+				for (auto b = bits(_mm256_and_si256(x, y)); b; b &= b - 1)
+				{
+					const auto k = i + low_bit(b);
+					if (m < 3 or m - 2 == iequal(s + k + 1, t + 1, m - 2))
+					{
+						return k;
+					}
+				}
+			}
+			return i + sse2::ifind(s + i, n - i, t, m);
+		}
+	}
+
+	namespace sse42
+	{
+		TARGET("sse4.2") std::uint32_t crc32c(std::uint32_t crc, const char* s, size_t n)
+		{
+			auto c = ~crc;
+			#if defined(__x86_64__) || defined(_M_X64)
+			{
+				std::uint64_t w = c;
+				for (; 8 <= n; s += 8, n -= 8)
+				{
+					std::uint64_t x;
+					std::memcpy(&x, s, sizeof x);
+					w = _mm_crc32_u64(w, x);
+				}
+				c = static_cast<std::uint32_t>(w);
+			}
+			#endif
+			for (; 4 <= n; s += 4, n -= 4)
+			{
+				std::uint32_t x;
+				std::memcpy(&x, s, sizeof x);
+				c = _mm_crc32_u32(c, x);
+			}
+			for (; 0 < n; ++s, --n)
+			{
+				c = _mm_crc32_u8(c, static_cast<unsigned char>(*s));
+			}
+			return ~c;
+		}
+	}
+
+	#endif // SIMD_X86
+
+	struct kernels
+	{
+		const char* name;
+		size_t (*find)(const char*, size_t, char);
+		size_t (*search)(const char*, size_t, const char*, size_t);
+		size_t (*find_of)(const char*, size_t, const char*, size_t);
+		size_t (*find_not_of)(const char*, size_t, const char*, size_t);
+		size_t (*count)(const char*, size_t, char);
+		size_t (*find_in)(const char*, size_t, const fmt::simd::charset&);
+		size_t (*find_not_in)(const char*, size_t, const fmt::simd::charset&);
+		void (*classify)(const char*, size_t, const fmt::simd::charset&, std::uint64_t*);
+		size_t (*ascii)(const char*, size_t);
+		size_t (*invalid)(const char*, size_t);
+		size_t (*runes)(const char*, size_t);
+		size_t (*iequal)(const char*, const char*, size_t);
+		size_t (*ifind)(const char*, size_t, const char*, size_t);
+	};
+
+	constexpr kernels generic
+	{
+		"scalar",
+		scalar::find,
+		scalar::find,
+		scalar::find_of,
+		scalar::find_not_of,
+		scalar::count,
+		scalar::find_in,
+		scalar::find_not_in,
+		scalar::classify,
+		scalar::ascii,
+		scalar::invalid,
+		scalar::runes,
+		scalar::iequal,
+		scalar::ifind,
+	};
+
+	#ifdef SIMD_X86
+
+	constexpr kernels sse2_kernels
+	{
+		"sse2",
+		sse2::find,
+		sse2::find,
+		sse2::find_of,
+		sse2::find_not_of,
+		sse2::count,
+		scalar::find_in,
+		scalar::find_not_in,
+		scalar::classify,
+		sse2::ascii,
+		sse2::invalid,
+		sse2::runes,
+		sse2::iequal,
+		sse2::ifind,
+	};
+
+	constexpr kernels avx2_kernels
+	{
+		"avx2",
+		avx2::find,
+		avx2::find,
+		avx2::find_of,
+		avx2::find_not_of,
+		avx2::count,
+		avx2::find_in,
+		avx2::find_not_in,
+		avx2::classify,
+		avx2::ascii,
+		avx2::invalid,
+		avx2::runes,
+		avx2::iequal,
+		avx2::ifind,
+	};
+
+	bool supports(const char* isa)
+	{
+		#ifdef _MSC_VER
+		{
+			int r[4];
+			__cpuid(r, 1);
+			const bool sse = r[3] & (1 << 26);
+			const bool sse42 = r[2] & (1 << 20);
+			const bool xsave = r[2] & (1 << 27);
+			if (0 == std::strcmp(isa, "sse2"))
+			{
+				return sse;
+			}
+			if (0 == std::strcmp(isa, "sse4.2"))
+			{
+				return sse42;
+			}
+			__cpuidex(r, 7, 0);
+			const bool avx = r[1] & (1 << 5);
+			return xsave and avx and 6 == (_xgetbv(0) & 6);
+		}
+		#else
+		{
+			__builtin_cpu_init();
+			if (0 == std::strcmp(isa, "sse4.2"))
+			{
+				return __builtin_cpu_supports("sse4.2");
+			}
+			return 0 == std::strcmp(isa, "sse2")
+				? __builtin_cpu_supports("sse2")
+				: __builtin_cpu_supports("avx2");
+		}
+		#endif
+	}
+
+	#endif // SIMD_X86
+
+	const kernels& pick()
+	{
+		static const kernels& k = []() -> const kernels&
+		{
+			#ifdef SIMD_X86
+			if (supports("avx2"))
+			{
+				return avx2_kernels;
+			}
+			if (supports("sse2"))
+			{
+				return sse2_kernels;
+			}
+			#endif
+			return generic;
+		}();
+		return k;
+	}
+}
+
+namespace fmt::simd
+{
+	const char* isa()
+	{
+		return pick().name;
+	}
+
+	size_t find(const char* s, size_t n, char c)
+	{
+		return pick().find(s, n, c);
+	}
+
+	size_t find(const char* s, size_t n, const char* t, size_t m)
+	{
+		return pick().search(s, n, t, m);
+	}
+
+	size_t find_of(const char* s, size_t n, const char* t, size_t m)
+	{
+		#ifdef assert
+		assert(m <= set_max);
+		#endif
+		return pick().find_of(s, n, t, m);
+	}
+
+	size_t find_not_of(const char* s, size_t n, const char* t, size_t m)
+	{
+		#ifdef assert
+		assert(m <= set_max);
+		#endif
+		return pick().find_not_of(s, n, t, m);
+	}
+
+	size_t count(const char* s, size_t n, char c)
+	{
+		return pick().count(s, n, c);
+	}
+
+	size_t find_in(const char* s, size_t n, const charset& t)
+	{
+		return pick().find_in(s, n, t);
+	}
+
+	size_t find_not_in(const char* s, size_t n, const charset& t)
+	{
+		return pick().find_not_in(s, n, t);
+	}
+
+	void classify(const char* s, size_t n, const charset& t, std::uint64_t* out)
+	{
+		pick().classify(s, n, t, out);
+	}
+
+	size_t ascii(const char* s, size_t n)
+	{
+		return pick().ascii(s, n);
+	}
+
+	size_t invalid(const char* s, size_t n)
+	{
+		return pick().invalid(s, n);
+	}
+
+	size_t runes(const char* s, size_t n)
+	{
+		return pick().runes(s, n);
+	}
+
+	size_t iequal(const char* s, const char* t, size_t n)
+	{
+		return pick().iequal(s, t, n);
+	}
+
+	size_t ifind(const char* s, size_t n, const char* t, size_t m)
+	{
+		return pick().ifind(s, n, t, m);
+	}
+
+	size_t count(const char* s, size_t n, const char* t, size_t m)
+	{
+		if (0 == m)
+		{
+			return 0;
+		}
+		size_t k = 0;
+		const auto& f = pick();
+		for (auto i = f.search(s, n, t, m); i < n; i += f.search(s + i, n - i, t, m))
+		{
+			i += m;
+			++ k;
+		}
+		return k;
+	}
+
+	std::uint32_t crc32c(std::uint32_t crc, const char* s, size_t n)
+	{
+		// Separate from the kernels since SSE4.2 is neither implied by SSE2 nor by AVX2
+		static const auto f = []
+		{
+			#ifdef SIMD_X86
+			if (supports("sse4.2"))
+			{
+				return sse42::crc32c;
+			}
+			#endif
+			return scalar::crc32c;
+		}();
+		return f(crc, s, n);
+	}
+}
+
+#ifdef TEST
+TEST(simd)
+{
+	using namespace fmt::simd;
+	const std::string_view sep = " \t\n:";
+	// Random mix of letters and separators at every alignment
+	unsigned seed = 42;
+	std::string buf;
+	for (int n = 0; n < 300; ++n)
+	{
+		seed = seed * 1103515245 + 12345;
+		buf += (seed >> 16) % 4 ? "ab:c\xE9 \t"[(seed >> 8) % 8] : sep[(seed >> 4) % 4];
+	}
+
+	charset set;
+	for (const auto c : sep)
+	{
+		set.insert(c);
+	}
+
+	for (size_t off = 0; off < 40; ++off)
+	{
+		const auto u = std::string_view(buf).substr(off);
+		const auto s = u.data();
+		const auto n = u.size();
+		const auto at = [n](size_t i) { return std::string_view::npos == i ? n : i; };
+
+		ASSERT(find(s, n, ':') == at(u.find(':')));
+		ASSERT(find(s, n, '!') == n);
+		ASSERT(find(s, n, "c\xE9", 2) == at(u.find("c\xE9")));
+		ASSERT(find(s, n, "a:b", 3) == at(u.find("a:b")));
+		ASSERT(find_of(s, n, sep.data(), sep.size()) == at(u.find_first_of(sep)));
+		ASSERT(find_not_of(s, n, sep.data(), sep.size()) == at(u.find_first_not_of(sep)));
+		ASSERT(count(s, n, 'a') == (size_t) std::count(u.begin(), u.end(), 'a'));
+		ASSERT(find_in(s, n, set) == at(u.find_first_of(sep)));
+		ASSERT(find_not_in(s, n, set) == at(u.find_first_not_of(sep)));
+
+		std::uint64_t bits[8];
+		classify(s, n, set, bits);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const bool in = sep.find(u[i]) != std::string_view::npos;
+			ASSERT(in == (1 & (bits[i / 64] >> (i % 64))));
+		}
+
+		size_t k = 0;
+		for (auto i = u.find("ab"); i != std::string_view::npos; i = u.find("ab", i + 2))
+		{
+			++ k;
+		}
+		ASSERT(count(s, n, "ab", 2) == k);
+
+		// Case of the letters on either side must not matter
+		std::string upper(u);
+		for (auto& c : upper)
+		{
+			if ('a' <= c and c <= 'z') c &= ~0x20;
+		}
+		for (size_t m = 0; m < 6 and m <= n; ++m)
+		{
+			const auto t = u.substr(n - m);
+			const auto i = at(u.find(t));
+			ASSERT(ifind(s, n, upper.data() + n - m, m) == i);
+			ASSERT(ifind(upper.data(), n, t.data(), m) == i);
+		}
+		ASSERT(iequal(s, upper.data(), n) == n);
+		if (0 < n)
+		{
+			upper[n / 2] = '!';
+			ASSERT(iequal(s, upper.data(), n) == n / 2);
+		}
+	}
+
+	// Check value from the catalog, in any split and at any alignment
+	ASSERT(0xE3069283 == crc32c(0, "123456789", 9));
+	ASSERT(0 == crc32c(0, "", 0));
+	const auto whole = crc32c(0, buf.data(), buf.size());
+	for (size_t n = 0; n < 40; ++n)
+	{
+		ASSERT(whole == crc32c(crc32c(0, buf.data(), n), buf.data() + n, buf.size() - n));
+		ASSERT(crc32c(0, buf.data() + n, 100) == crc32c(0, std::string(buf, n, 100).data(), 100));
+	}
+}
+#endif
@@ -0,0 +1,319 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "subst.hpp"
+#include <algorithm>
+
+namespace fmt
+{
+	template <class C> basic_replacer<C>::basic_replacer(span t)
+	{
+		// Number the units which appear in any needle
+		for (const auto& [v, w] : t)
+		{
+			for (const auto c : v)
+			{
+				if (0 == unit(c))
+				{
+					const auto n = static_cast<std::make_unsigned_t<C>>(c);
+					if (n < 256) small[n] = width++;
+					else large[c] = width++;
+				}
+			}
+		}
+
+		// Trie of the reversed needles with missing edges as -1
+		jump.assign(width, -1);
+		match.push_back(-1);
+		lead.assign(width, 0);
+		for (const auto& [v, w] : t)
+		{
+			if (v.empty())
+			{
+				continue;
+			}
+
+			int node = 0;
+			for (auto n = v.size(); 0 < n; --n)
+			{
+				const auto edge = node * width + unit(v[n - 1]);
+				if (jump[edge] < 0)
+				{
+					jump[edge] = static_cast<int>(match.size());
+					jump.resize(jump.size() + width, -1);
+					match.push_back(-1);
+				}
+				node = jump[edge];
+			}
+
+			// The first of any duplicates wins
+			if (match[node] < 0)
+			{
+				match[node] = static_cast<int>(length.size());
+				length.push_back(v.size());
+				offset.emplace_back(text.size(), w.size());
+				longest = std::max(longest, v.size());
+				text += w;
+			}
+
+			lead[unit(v.front())] = 1;
+			const auto n = static_cast<std::make_unsigned_t<C>>(v.front());
+			if (n < 256)
+			{
+				first.insert(static_cast<unsigned char>(n));
+			}
+		}
+
+		// Fill missing edges from the failure links in breadth first order
+		fwd::vector<int> fail(match.size(), 0), queue;
+		for (int c = 0; c < width; ++c)
+		{
+			auto& to = jump[c];
+			if (to < 0) to = 0;
+			else queue.push_back(to);
+		}
+		for (size_type q = 0; q < queue.size(); ++q)
+		{
+			const auto node = queue[q];
+			if (match[node] < 0)
+			{
+				match[node] = match[fail[node]];
+			}
+			for (int c = 0; c < width; ++c)
+			{
+				auto& to = jump[node * width + c];
+				const auto back = jump[fail[node] * width + c];
+				if (to < 0)
+				{
+					to = back;
+				}
+				else
+				{
+					fail[to] = back;
+					queue.push_back(to);
+				}
+			}
+		}
+	}
+
+	template <class C> int basic_replacer<C>::unit(C c) const
+	{
+		const auto n = static_cast<std::make_unsigned_t<C>>(c);
+		if (n < 256)
+		{
+			return small[n];
+		}
+		const auto it = large.find(c);
+		return large.end() == it ? 0 : it->second;
+	}
+
+	template <class C> typename basic_replacer<C>::view basic_replacer<C>::with(int k) const
+	{
+		const auto [pos, size] = offset[k];
+		return view(text).substr(pos, size);
+	}
+
+	template <class C> size_type basic_replacer<C>::skip(view u) const
+	{
+		if constexpr (std::is_same<C, char>::value)
+		{
+			return simd::find_in(u.data(), u.size(), first);
+		}
+		else
+		{
+			const auto it = std::find_if(u.begin(), u.end(), [this](C c)
+			{
+				return 0 != lead[unit(c)];
+			});
+			return std::distance(u.begin(), it);
+		}
+	}
+
+	template <class C> template <class Out> size_type basic_replacer<C>::run(view u, cursor& at, bool last, Out out) const
+	{
+		const auto n = u.size();
+		const auto reach = std::max<size_type>(longest, 1);
+		while (at.i < n)
+		{
+			// Nothing matches before a unit that begins a needle
+			at.i += skip(u.substr(at.i));
+			if (n == at.i)
+			{
+				break;
+			}
+
+			// A start is settled once its longest needle would be in view
+			const auto from = at.i, end = std::min(n, from + 2 * reach - 1);
+			auto stop = end;
+			if (not last or end < n)
+			{
+				if (end < from + reach)
+				{
+					break;
+				}
+				stop = end + 1 - reach;
+			}
+
+			// Backwards the automaton is at the longest needle at each start
+			at.best.assign(stop - from, -1);
+			int node = 0;
+			for (auto j = end; from < j; --j)
+			{
+				node = next(node, u[j - 1]);
+				if (j <= stop)
+				{
+					at.best[j - 1 - from] = match[node];
+				}
+			}
+
+			// Forwards take the leftmost of them without overlaps
+			while (at.i < stop)
+			{
+				if (const auto k = at.best[at.i - from]; 0 <= k)
+				{
+					out(u.substr(at.done, at.i - at.done));
+					out(with(k));
+					at.done = at.i += length[k];
+					++ at.count;
+				}
+				else
+				{
+					++ at.i;
+				}
+			}
+		}
+
+		// Text before the first unsettled start is plain
+		out(u.substr(at.done, at.i - at.done));
+		at.done = at.i;
+		return at.done;
+	}
+
+	template <class C> typename basic_replacer<C>::string basic_replacer<C>::replace(view u) const
+	{
+		string s;
+		(void) replace_to(s, u);
+		return s;
+	}
+
+	template <class C> typename basic_replacer<C>::string& basic_replacer<C>::replace_to(string& s, view u) const
+	{
+		s.clear();
+		s.reserve(u.size());
+		cursor at;
+		(void) run(u, at, true, [&s](view v)
+		{
+			s += v;
+		});
+		return s;
+	}
+
+	template <class C> typename basic_replacer<C>::output basic_replacer<C>::replace(input in, output out) const
+	{
+		constexpr size_type chunk = 4096;
+		const auto put = [&out](view v)
+		{
+			(void) out.write(v.data(), v.size());
+		};
+
+		string buf;
+		cursor at;
+		while (in)
+		{
+			const auto z = buf.size();
+			buf.resize(z + chunk);
+			(void) in.read(buf.data() + z, chunk);
+			buf.resize(z + in.gcount());
+			// Keep only what a needle may still span
+			const auto done = run(buf, at, not in, put);
+			buf.erase(0, done);
+			at.shift(done);
+		}
+		return out;
+	}
+
+	template <class C> size_type basic_replacer<C>::count(view u) const
+	{
+		cursor at;
+		(void) run(u, at, true, [](view) { });
+		return at.count;
+	}
+
+	template class basic_replacer<char>;
+	template class basic_replacer<wchar_t>;
+}
+
+#ifdef TEST
+#include <sstream>
+TEST(subst)
+{
+	// Template tokens in either style
+	{
+		const fmt::replacer r
+		{
+			{ "$HOME", "/home/me" }, { "$USER", "me" }, { "%PATH%", "/bin" }
+		};
+		ASSERT(3 == r.size());
+		ASSERT(r.replace("cd $HOME; echo $USER:%PATH%$") == "cd /home/me; echo me:/bin$");
+		ASSERT(r.replace("nothing here") == "nothing here");
+		ASSERT(r.replace("").empty());
+		ASSERT(2 == r.count("$USER$USER%PATH"));
+	}
+
+	// Leftmost then longest, without overlaps
+	{
+		const fmt::replacer r { { "bc", "X" }, { "abcd", "Y" }, { "c", "Z" } };
+		ASSERT(r.replace("abcde") == "Ye");
+		ASSERT(r.replace("abce") == "aXe");
+		ASSERT(r.replace("cabc") == "ZaX");
+		const fmt::replacer s { { "a", "1" }, { "ab", "2" }, { "aa", "b" } };
+		ASSERT(s.replace("abab") == "22");
+		ASSERT(s.replace("aaaaa") == "bb1");
+		ASSERT(3 == s.count("aaaaa"));
+	}
+
+	// A long needle that keeps failing at its last unit
+	{
+		const fmt::replacer r { { "a", "1" }, { "aaaaab", "X" } };
+		fmt::string s(1000, 'a');
+		ASSERT(r.replace(s) == fmt::string(1000, '1'));
+		ASSERT(r.replace("aaaaaaab aaaab") == "11X 1111b");
+		s += "aaaaab";
+		ASSERT(1001 == r.count(s));
+	}
+
+	// Duplicates and empty needles
+	{
+		const fmt::replacer r { { "x", "1" }, { "x", "2" }, { "", "?" } };
+		ASSERT(1 == r.size());
+		ASSERT(r.replace("axb") == "a1b");
+	}
+
+	// One needle agrees with replace
+	{
+		const fmt::view Text = "the cat sat on the mat with the other cat";
+		const fmt::replacer r { { "at", "og" } };
+		ASSERT(r.replace(Text) == fmt::replace(Text, "at", "og"));
+	}
+
+	// Streams hold back a needle that crosses a read
+	{
+		fmt::string s(4094, '.');
+		s += "$HOME/$USER";
+		s += fmt::string(5000, '$');
+		const fmt::replacer r { { "$HOME", "~" }, { "$USER", "me" }, { "$$$", "3" } };
+		std::istringstream in(s);
+		std::ostringstream out;
+		(void) r.replace(in, out);
+		ASSERT(out.str() == r.replace(s));
+		ASSERT(out.str().starts_with(fmt::string(4094, '.') + "~/me33"));
+	}
+
+	// Wide units beyond a byte
+	{
+		const fmt::wreplacer r { { L"été", L"summer" }, { L"一", L"one" } };
+		ASSERT(r.replace(L"l'été 一") == L"l'summer one");
+	}
+}
+#endif
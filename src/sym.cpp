@@ -26,7 +26,7 @@ namespace sys
 
 	lib::lib(fmt::view path)
 	{
-		const auto buf = fmt::to_string(path);
+		const fmt::cstr buf(path);
 		const auto s = buf.data();
 
 		#ifdef _WIN32
@@ -87,7 +87,7 @@ namespace sys
 
 	void *lib::sym(fmt::string::view name) const
 	{
-		const auto buf = fmt::to_string(name);
+		const fmt::cstr buf(name);
 		const auto s = buf.data();
 
 		#ifdef _WIN32
@@ -309,6 +309,60 @@ namespace sys
 		}
 		#endif
 	}
+
+	#ifdef _MSC_VER
+	// One call per vector, stopping short where the device does
+
+	ssize_t readv(int fd, const iovec* iov, int count)
+	{
+		// A pipe or console may block on the vectors after the first
+		if (1 < count)
+		{
+			struct stats st(fd);
+			if (fail(st.ok) or not S_ISREG(st.st_mode))
+			{
+				count = 1;
+			}
+		}
+
+		ssize_t total = 0;
+		for (int n = 0; n < count; ++n)
+		{
+			const auto size = static_cast<unsigned>(iov[n].iov_len);
+			const auto k = read(fd, iov[n].iov_base, size);
+			if (k < 0)
+			{
+				return 0 < total ? total : k;
+			}
+			total += k;
+			if (static_cast<unsigned>(k) < size)
+			{
+				break;
+			}
+		}
+		return total;
+	}
+
+	ssize_t writev(int fd, const iovec* iov, int count)
+	{
+		ssize_t total = 0;
+		for (int n = 0; n < count; ++n)
+		{
+			const auto size = static_cast<unsigned>(iov[n].iov_len);
+			const auto k = write(fd, iov[n].iov_base, size);
+			if (k < 0)
+			{
+				return 0 < total ? total : k;
+			}
+			total += k;
+			if (static_cast<unsigned>(k) < size)
+			{
+				break;
+			}
+		}
+		return total;
+	}
+	#endif
 }
 
 #ifdef _WIN32
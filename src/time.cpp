@@ -43,17 +43,17 @@ namespace env
 
 	fmt::access date::operator()(fmt::view format)
 	{
+		// Terminate the format once rather than on every use
+		const auto s = fmt::to_string(format);
 		return
 		{
-			[=](fmt::input in)->fmt::input
+			[this, s](fmt::input in)->fmt::input
 			{
-				const auto s = fmt::to_string(format);
 				return in >> std::get_time(this, s.data());
 			}
 			,
-			[=](fmt::output out)->fmt::output
+			[this, s](fmt::output out)->fmt::output
 			{
-				const auto s = fmt::to_string(format);
 				return out << std::put_time(this, s.data());
 			}
 		};
@@ -177,5 +177,11 @@ TEST(time)
 		auto s = ss.str();
 		ASSERT(not s.empty());
 	}
+	// Specs parsed when compiled give the same text
+	{
+		std::stringstream ss;
+		ss << local("%F %T");
+		ASSERT(ss.str() == fmt::format<"{:%F %T}">(local));
+	}
 }
 #endif
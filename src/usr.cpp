@@ -39,7 +39,7 @@ namespace env::usr
 
 		using entry = std::pair<KNOWNFOLDERID, fmt::view>;
 
-		static const std::map<fmt::string::view, entry> map =
+		static const fwd::flat_map<fmt::string::view, entry> map =
 		{
 			{ "AccountPictures", entry{FOLDERID_AccountPictures, "%AppData%\\Microsoft\\Windows\\AccountPictures"}},
 			{ "AdminTools", entry{FOLDERID_AdminTools, "%AppData%\\Microsoft\\Windows\\Start Menu\\Programs\\Administrative Tools"}},
@@ -125,7 +125,9 @@ namespace env::usr
 
 	#else
 
-		static const std::map<fmt::view, fmt::pair> map =
+		using entry = fwd::pair<std::string_view, fwd::pair<std::string_view>>;
+
+		static constexpr entry table[] =
 		{
 			{"Cache-Home", {"XDG_CACHE_HOME", "$HOME/.cache"}},
 			{"Config-Dirs", {"XDG_CONFIG_DIRS", "/etc/xdg"}},
@@ -144,6 +146,10 @@ namespace env::usr
 			{"Videos", {"XDG_VIDEOS_DIR", "$HOME/Videos"}},
 		};
 
+		// Sorted when compiled
+		static constexpr fwd::static_map map(table);
+		static_assert(map.unique());
+
 		static const auto dirs [[maybe_unused]] =  user_dirs();
 
 		if (auto it = map.find(name); map.end() != it)
@@ -152,8 +158,8 @@ namespace env::usr
 			assert(name == it->first);
 			#endif
 
-			auto [id, path] = it->second;
-			u = env::opt::get(id, path);
+			const auto [id, path] = it->second;
+			u = env::opt::get(fmt::view(id), fmt::view(path));
 		}
 
 	#endif
@@ -167,7 +173,8 @@ namespace env::usr
 
 	fmt::view path(fmt::view file)
 	{
-		return fmt::path::join({ run_dir(), file });
+		static thread_local fmt::string buf;
+		return fmt::dir::join_to(buf, { run_dir(), file });
 	}
 
 	fmt::view current_desktop()
@@ -294,8 +301,7 @@ namespace env::usr
 			}
 			#endif
 		}
-		t = fmt::path::split(u);
-		return t;
+		return fmt::path::tokenize(u).to(t);
 	}
 
 	fmt::span config_dirs()
@@ -322,8 +328,7 @@ namespace env::usr
 		}
 
 		static fmt::vector buf;
-		buf = fmt::path::split(u);
-		return buf;
+		return fmt::path::tokenize(u).to(buf);
 	}
 }
 
@@ -404,4 +409,4 @@ TEST(usr)
 
 	out << env::opt::put << std::endl;
 }
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
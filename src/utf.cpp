@@ -0,0 +1,266 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "err.hpp"
+#include "utf.hpp"
+#include "simd.hpp"
+#include <algorithm>
+
+namespace
+{
+	using fmt::size_type;
+	using fmt::npos;
+	using byte = unsigned char;
+
+	constexpr char32_t ill = ~char32_t(0);
+	// Marks an ill formed sequence while decoding
+
+	char32_t next(const byte*& it, const byte* end)
+	// Decode at $it and step over it or over the maximal ill formed part
+	{
+		const unsigned b = *it++;
+		if (b < 0x80)
+		{
+			return b;
+		}
+		if (b < 0xC2 or 0xF4 < b)
+		{
+			return ill;
+		}
+		// Range of the second byte narrows for some leads
+		unsigned lo = 0x80, hi = 0xBF;
+		switch (b)
+		{
+		case 0xE0: lo = 0xA0; break;
+		case 0xED: hi = 0x9F; break;
+		case 0xF0: lo = 0x90; break;
+		case 0xF4: hi = 0x8F; break;
+		}
+		const int m = b < 0xE0 ? 1 : b < 0xF0 ? 2 : 3;
+		char32_t c = b & (0x3F >> m);
+		for (int j = 0; j < m; ++j)
+		{
+			if (end == it or *it < lo or hi < *it)
+			{
+				return ill;
+			}
+			c = (c << 6) | (*it++ & 0x3F);
+			lo = 0x80, hi = 0xBF;
+		}
+		return c;
+	}
+
+	template <class Char, class Op> void each(fwd::basic_string_view<Char> w, Op op)
+	// Call $op with each code point in $w and its position, or ill
+	{
+		const auto n = w.size();
+		for (size_type i = 0; i < n; ++i)
+		{
+			char32_t c = static_cast<std::make_unsigned_t<Char>>(w[i]);
+			if constexpr (sizeof(Char) < sizeof(char32_t))
+			{
+				// Join surrogate pairs
+				if (0xD800 <= c and c < 0xDC00 and i + 1 < n)
+				{
+					const char32_t d = static_cast<std::make_unsigned_t<Char>>(w[i + 1]);
+					if (0xDC00 <= d and d < 0xE000)
+					{
+						op(0x10000 + ((c - 0xD800) << 10) + (d - 0xDC00), i);
+						++ i;
+						continue;
+					}
+				}
+			}
+			const bool surrogate = 0xD800 <= c and c < 0xE000;
+			op(surrogate or 0x10FFFF < c ? ill : c, i);
+		}
+	}
+
+	size_type bytes(char32_t c)
+	{
+		return c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+	}
+
+	char* put(char* out, char32_t c)
+	// Store $c as UTF-8 at $out
+	{
+		if (c < 0x80)
+		{
+			*out++ = static_cast<char>(c);
+		}
+		else
+		if (c < 0x800)
+		{
+			*out++ = static_cast<char>(0xC0 | (c >> 6));
+			*out++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		if (c < 0x10000)
+		{
+			*out++ = static_cast<char>(0xE0 | (c >> 12));
+			*out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			*out++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			*out++ = static_cast<char>(0xF0 | (c >> 18));
+			*out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			*out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			*out++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		return out;
+	}
+
+	template <class Char> Char* put(Char* out, char32_t c)
+	// Store $c as UTF-16 or UTF-32 at $out
+	{
+		if constexpr (sizeof(Char) < sizeof(char32_t))
+		{
+			if (0xFFFF < c)
+			{
+				c -= 0x10000;
+				*out++ = static_cast<Char>(0xD800 + (c >> 10));
+				*out++ = static_cast<Char>(0xDC00 + (c & 0x3FF));
+				return out;
+			}
+		}
+		*out++ = static_cast<Char>(c);
+		return out;
+	}
+}
+
+namespace fmt::utf
+{
+	size_type check(view u)
+	{
+		const auto n = u.size();
+		const auto i = simd::invalid(u.data(), n);
+		return i < n ? i : npos;
+	}
+
+	size_type count(view u)
+	{
+		return simd::runes(u.data(), u.size());
+	}
+
+	template <class Char> basic_string<Char> decode(view u, size_type* pos)
+	{
+		if (nullptr != pos)
+		{
+			*pos = npos;
+		}
+		// No more code units than bytes in either form
+		basic_string<Char> w(u.size(), Char());
+		const auto begin = reinterpret_cast<const byte*>(u.data());
+		const auto end = begin + u.size();
+		auto out = w.data();
+		for (auto it = begin; it != end;)
+		{
+			if (*it < 0x80)
+			{
+				// Widen a run of ASCII at once
+				const auto s = reinterpret_cast<const char*>(it);
+				const auto n = simd::ascii(s, end - it);
+				out = std::copy(it, it + n, out);
+				it += n;
+			}
+			else
+			{
+				const auto at = it;
+				auto c = next(it, end);
+				if (ill == c)
+				{
+					if (nullptr != pos and npos == *pos)
+					{
+						*pos = at - begin;
+					}
+					c = bad;
+				}
+				out = put(out, c);
+			}
+		}
+		w.resize(out - w.data());
+		return w;
+	}
+
+	template <class Char> string encode(fwd::basic_string_view<Char> w, size_type* pos)
+	{
+		if (nullptr != pos)
+		{
+			*pos = npos;
+		}
+		// Measure so that output is allocated once
+		size_type n = 0;
+		each(w, [&n](char32_t c, size_type)
+		{
+			n += bytes(ill == c ? bad : c);
+		});
+		string s(n, '\0');
+		auto out = s.data();
+		each(w, [&out, pos](char32_t c, size_type i)
+		{
+			if (ill == c)
+			{
+				if (nullptr != pos and npos == *pos)
+				{
+					*pos = i;
+				}
+				c = bad;
+			}
+			out = put(out, c);
+		});
+		return s;
+	}
+
+	template wstring decode<wchar_t>(view, size_type*);
+	template ustring decode<char32_t>(view, size_type*);
+	template basic_string<char16_t> decode<char16_t>(view, size_type*);
+
+	template string encode<wchar_t>(fwd::basic_string_view<wchar_t>, size_type*);
+	template string encode<char32_t>(fwd::basic_string_view<char32_t>, size_type*);
+	template string encode<char16_t>(fwd::basic_string_view<char16_t>, size_type*);
+}
+
+#ifdef TEST
+TEST(utf)
+{
+	const fmt::view Hello = "Hello, World!";
+	const fmt::view Mixed = "na\xC3\xAFve \xE2\x82\xAC \xF0\x9F\x98\x80!";
+	const std::u32string_view Points = U"naïve € \U0001F600!";
+
+	// Well formed input round trips
+	{
+		ASSERT(fmt::npos == fmt::utf::check(Hello));
+		ASSERT(fmt::npos == fmt::utf::check(Mixed));
+		ASSERT(fmt::utf::count(Hello) == Hello.size());
+		ASSERT(fmt::utf::count(Mixed) == Points.size());
+
+		fmt::size_type pos = 0;
+		const auto u = fmt::utf::decode<char32_t>(Mixed, &pos);
+		ASSERT(fmt::npos == pos);
+		ASSERT(u == Points);
+		ASSERT(fmt::utf::encode<char32_t>(u, &pos) == Mixed);
+		ASSERT(fmt::npos == pos);
+
+		const auto w = fmt::utf::decode<char16_t>(Mixed);
+		ASSERT(w.size() == Points.size() + 1);
+		ASSERT(fmt::utf::encode<char16_t>(w) == Mixed);
+	}
+
+	// Ill formed input is replaced and reported
+	{
+		const fmt::view Bad = "ok\xC0\xAF \xED\xA0\x80 \xE2\x82";
+		ASSERT(2 == fmt::utf::check(Bad));
+
+		fmt::size_type pos = 0;
+		const auto u = fmt::utf::decode<char32_t>(Bad, &pos);
+		ASSERT(2 == pos);
+		ASSERT(u == U"ok�� ��� �");
+
+		const char32_t lone[] = { 'a', 0xD800, 'b', 0x110000 };
+		const auto s = fmt::utf::encode<char32_t>({ lone, 4 }, &pos);
+		ASSERT(1 == pos);
+		ASSERT(s == "a\xEF\xBF\xBD" "b\xEF\xBF\xBD");
+	}
+}
+#endif